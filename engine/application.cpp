@@ -23,6 +23,7 @@ namespace al
             {
                 for_each_subsystem<SubsystemActionUpdate>(&application->bindings.subsystems, (typename Bindings::ApplicationType*)application);
             }
+            al_memory_stats(application_log_memory_statistics(application));
             logger_flush(application->logger);
             stack_alloactor_reset(&application->frameAllocator);
         }
@@ -64,27 +65,32 @@ namespace al
         }
 
         AllocatorBindings systemAllocatorBindings = get_system_allocator_bindings();
-        construct(&application->stack, EngineConfig::STACK_ALLOCATOR_MEMORY_SIZE, &systemAllocatorBindings);
+        construct_virtual(&application->stack, EngineConfig::STACK_ALLOCATOR_RESERVE_SIZE, EngineConfig::STACK_ALLOCATOR_MEMORY_SIZE);
         constexpr PoolAllocatorBucketDescription bucketDescriptions[EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS] = 
         {
             memory_bucket_desc(8, EngineConfig::POOL_ALLOCATOR_MEMORY_SIZE),
         };
         construct(&application->pool, bucketDescriptions, &systemAllocatorBindings);
-        construct(&application->frameAllocator, EngineConfig::FRAME_ALLOCATOR_MEMORY_SIZE, &systemAllocatorBindings);
+        construct_virtual(&application->frameAllocator, EngineConfig::FRAME_ALLOCATOR_RESERVE_SIZE, EngineConfig::FRAME_ALLOCATOR_MEMORY_SIZE);
+        construct(&application->heap, EngineConfig::HEAP_ALLOCATOR_MEMORY_SIZE, &systemAllocatorBindings);
         application->stackBindings = get_allocator_bindings(&application->stack);
         application->poolBindings = get_allocator_bindings(&application->pool);
         application->frameBindings = get_allocator_bindings(&application->frameAllocator);
+        application->heapBindings = get_allocator_bindings(&application->heap);
 
         LoggerCreateInfo loggerCreateInfo { };
         unwrap(platform_file_get_std_out(&loggerCreateInfo.outputs[0]));
         application->logger = allocate<Logger>(&application->poolBindings);
         logger_construct(application->logger, &loggerCreateInfo);
 
+        application->jobSystem = allocate<JobSystem>(&application->poolBindings);
         application->globals =
         {
             .logger = application->logger,
+            .jobSystem = application->jobSystem,
         };
         thread_local_globals_register(&application->globals);
+        job_system_construct(application->jobSystem, &application->heapBindings, &application->globals);
 
         platform_window_construct(&application->window, creationData.windowInitData);
         platform_window_set_resize_callback(&application->window, [application](){
@@ -98,7 +104,7 @@ namespace al
 
         RendererInitData rendererInitData
         {
-            .persistentAllocator    = get_allocator_bindings(&application->pool),
+            .persistentAllocator    = get_allocator_bindings(&application->heap),
             .frameAllocator         = get_allocator_bindings(&application->frameAllocator),
             .window                 = &application->window,
             .renderApi              = creationData.renderApi,
@@ -109,6 +115,10 @@ namespace al
     template<typename Bindings>
     void application_default_destroy(Application<Bindings>* application)
     {
+        job_system_destroy(application->jobSystem);
+        deallocate(&application->poolBindings, application->jobSystem);
+        // Worker threads have exited, so blocks left in their caches are returned to the buckets
+        pool_allocator_flush_thread_caches(&application->pool);
         renderer_default_destroy(&application->renderer);
         platform_input_destruct(&application->input);
         platform_window_destruct(&application->window);
@@ -117,6 +127,7 @@ namespace al
         destruct(&application->pool);
         destruct(&application->stack);
         destruct(&application->frameAllocator);
+        destruct(&application->heap);
     }
 
     template<typename Bindings>
@@ -138,4 +149,27 @@ namespace al
             return platform_window_is_close_button_pressed(&application->window) || platform_input_is_keyboard_input_active(&application->input, KeyboardInput::ESCAPE);
         }
     }
+
+    template<typename Bindings>
+    void application_log_memory_statistics(Application<Bindings>* application)
+    {
+        log_allocator_statistics("stack", &application->stack.stats);
+        log_allocator_statistics("frame", &application->frameAllocator.stats);
+        log_allocator_statistics("heap", &application->heap.stats);
+        log_allocator_statistics("pool", &application->pool.stats);
+        for (al_iterator(it, application->pool.buckets))
+        {
+            if (!get(it)->memory) break;
+            PoolAllocatorBucketStatistics bucketStats = memory_bucket_get_statistics(get(it));
+            al_log_message("[memory] pool bucket %llu (%llu bytes) : used %llu / %llu blocks, free list %llu, largest free run %llu",
+                to_index(it), bucketStats.blockSizeBytes, bucketStats.usedBlocks, bucketStats.blockCount, bucketStats.freeListBlocks, bucketStats.largestFreeRunBlocks);
+        }
+        al_log_message("[memory] heap largest free block %llu bytes", tlsf_largest_free_block(&application->heap));
+    }
+
+    void log_allocator_statistics(const char* name, AllocatorStatistics* stats)
+    {
+        al_log_message("[memory] %s : live %llu, peak %llu, allocs %llu, frees %llu", name,
+            u64(stats->liveBytes), u64(stats->peakBytes), u64(stats->numAllocations), u64(stats->numDeallocations));
+    }
 }
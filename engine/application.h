@@ -6,6 +6,7 @@
 #include "engine/render/renderer.h"
 #include "engine/utilities/utilities.h"
 #include "engine/thread_local_globals/thread_local_globals.h"
+#include "engine/job_system/job_system.h"
 
 namespace al
 {
@@ -25,15 +26,18 @@ namespace al
         StackAllocator  stack;
         PoolAllocator   pool;
         StackAllocator  frameAllocator;
+        TlsfAllocator   heap;
 
         AllocatorBindings stackBindings;
         AllocatorBindings poolBindings;
         AllocatorBindings frameBindings;
+        AllocatorBindings heapBindings;
 
         PlatformWindow      window;
         PlatformInput       input;
         Renderer            renderer;
         Logger*             logger;
+        JobSystem*          jobSystem;
         ApplicationGlobals  globals;
 
         Bindings bindings;
@@ -53,6 +57,9 @@ namespace al
     template<typename Bindings> void                    application_default_update              (Application<Bindings>* application);
     template<typename Bindings> void                    application_default_render              (Application<Bindings>* application);
     template<typename Bindings> bool                    application_should_quit                 (Application<Bindings>* application);
+    template<typename Bindings> void                    application_log_memory_statistics       (Application<Bindings>* application);
+
+    void log_allocator_statistics(const char* name, AllocatorStatistics* stats);
 }
 
 #endif
@@ -11,9 +11,15 @@ namespace al
         static constexpr uSize DEFAULT_MEMORY_ALIGNMENT     = 8;
         static constexpr uSize MAX_MEMORY_ALIGNMENT         = 1024;
         static constexpr uSize POOL_ALLOCATOR_MAX_BUCKETS   = 8;
-        static constexpr uSize STACK_ALLOCATOR_MEMORY_SIZE  = 16 * 1024 * 1024; // 16 MB
+        static constexpr uSize POOL_ALLOCATOR_MAX_THREAD_CACHES = 64;
+        static constexpr uSize STACK_ALLOCATOR_MEMORY_SIZE  = 16 * 1024 * 1024; // 16 MB - stays commited after reset
+        static constexpr uSize STACK_ALLOCATOR_RESERVE_SIZE = uSize(4) * 1024 * 1024 * 1024; // 4 GB of address space
         static constexpr uSize POOL_ALLOCATOR_MEMORY_SIZE   = 64 * 1024 * 1024; // 64 MB
-        static constexpr uSize FRAME_ALLOCATOR_MEMORY_SIZE  = 16 * 1024 * 1024; // 16 MB
+        static constexpr uSize FRAME_ALLOCATOR_MEMORY_SIZE  = 16 * 1024 * 1024; // 16 MB - stays commited after reset
+        static constexpr uSize HEAP_ALLOCATOR_MEMORY_SIZE   = 64 * 1024 * 1024; // 64 MB
+        static constexpr uSize FRAME_ALLOCATOR_RESERVE_SIZE = uSize(1) * 1024 * 1024 * 1024; // 1 GB of address space
+        static constexpr uSize IN_FLIGHT_FRAME_ALLOCATOR_MEMORY_SIZE  = 4 * 1024 * 1024; // 4 MB per frame in flight - stays commited after reset
+        static constexpr uSize IN_FLIGHT_FRAME_ALLOCATOR_RESERVE_SIZE = 256 * 1024 * 1024; // 256 MB of address space per frame in flight
         static constexpr uSize PLATFORM_FILE_PATH_SIZE      = 64;
     };
 }
@@ -5,6 +5,8 @@
 
 #ifdef _WIN32
 #   define al_debug_break __debugbreak
+#elif defined(__linux__)
+#   define al_debug_break __builtin_trap
 #else
 #   error unsupported platform
 #endif
@@ -10,27 +10,29 @@ namespace al
 {
     void logger_wait_for_writes(Logger* logger)
     {
-        while (platform_atomic_64_bit_load(&logger->isWritingToOuptuts, MemoryOrder::ACQUIRE))
-        {
-            platform_thread_yield();
-        }
+        adaptive_wait_while_equal(&logger->writesWait, &logger->isWritingToOuptuts, u32(1));
     }
 
     void logger_write_all_messages(Logger* logger)
     {
-        LogMessage message;
-        while (thread_safe_queue_dequeue(&logger->messageQueue, &message))
+        // MAX_LOG_LENGTH = longest SEVERETY_STR + FMT additional symbols + text buffer size
+        constexpr uSize MAX_LOG_LENGTH = 7 + 4 + LogMessage::TEXT_BUFFER_SIZE;
+        constexpr const char* SEVERETY_STR[] = { "message", "warning", "error" };
+        constexpr const char* FMT = "[%s] %s\n";
+        // Messages are dequeued in batches and each batch is written to outputs with a single write call
+        LogMessage messages[Logger::MESSAGE_BATCH_SIZE];
+        char fullFormattedLogs[Logger::MESSAGE_BATCH_SIZE * MAX_LOG_LENGTH];
+        while (uSize numMessages = thread_safe_queue_dequeue_bulk(&logger->messageQueue, messages, Logger::MESSAGE_BATCH_SIZE))
         {
-            // MAX_LOG_LENGTH = longest SEVERETY_STR + FMT additional symbols + text buffer size
-            constexpr uSize MAX_LOG_LENGTH = 7 + 4 + LogMessage::TEXT_BUFFER_SIZE;
-            constexpr const char* SEVERETY_STR[] = { "message", "warning", "error" };
-            constexpr const char* FMT = "[%s] %s\n";
-            char fullFormattedLog[MAX_LOG_LENGTH] = {};
-            uSize strLength = std::snprintf(fullFormattedLog, MAX_LOG_LENGTH, FMT, SEVERETY_STR[(u8)message.severety], message.text);
+            uSize strLength = 0;
+            for (uSize it = 0; it < numMessages; it++)
+            {
+                strLength += std::snprintf(fullFormattedLogs + strLength, MAX_LOG_LENGTH, FMT, SEVERETY_STR[(u8)messages[it].severety], messages[it].text);
+            }
             for (al_iterator(it, logger->outputs))
             {
                 if (!platform_file_is_valid(get(it))) break;
-                unwrap(platform_file_write(get(it), fullFormattedLog, strLength));
+                unwrap(platform_file_write(get(it), fullFormattedLogs, strLength));
             }
         }
     }
@@ -45,7 +47,8 @@ namespace al
         }
         std::memset(&logger->queueCells, 0, sizeof(logger->queueCells));
         thread_safe_queue_construct(&logger->messageQueue, logger->queueCells, Logger::MESSAGE_QUEUE_SIZE);
-        platform_atomic_64_bit_store(&logger->isWritingToOuptuts, false, MemoryOrder::RELAXED);
+        platform_atomic_64_bit_store(&logger->isWritingToOuptuts, u32(0), MemoryOrder::RELAXED);
+        adaptive_wait_construct(&logger->writesWait);
     }
 
     void logger_destroy(Logger* logger)
@@ -60,13 +63,14 @@ namespace al
 
     bool logger_flush(Logger* logger)
     {
-        bool expected = false;
+        u32 expected = 0;
         // Try to lock the writing flag
-        if (platform_atomic_64_bit_cas(&logger->isWritingToOuptuts, &expected, true, MemoryOrder::ACQUIRE_RELEASE))
+        if (platform_atomic_64_bit_cas(&logger->isWritingToOuptuts, &expected, u32(1), MemoryOrder::ACQUIRE_RELEASE))
         {
             // If flag is locked by this thread, print all messages
             logger_write_all_messages(logger);
-            platform_atomic_64_bit_store(&logger->isWritingToOuptuts, false, MemoryOrder::RELEASE);
+            platform_atomic_64_bit_store(&logger->isWritingToOuptuts, u32(0), MemoryOrder::SEQUENTIALLY_CONSISTENT);
+            adaptive_wait_notify_all(&logger->writesWait, &logger->isWritingToOuptuts);
             return true;
         }
         // return false if someone is already flushing message queue
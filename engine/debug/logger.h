@@ -3,6 +3,7 @@
 
 #include "result.h"
 #include "engine/utilities/thread_safe_queue.h"
+#include "engine/utilities/adaptive_wait.h"
 #include "engine/platform/platform.h"
 
 // @NOTE : can't use "unwrap" macro here for some reason
@@ -37,12 +38,14 @@ namespace al
     struct Logger
     {
         static constexpr uSize MESSAGE_QUEUE_SIZE = 2048;
+        static constexpr uSize MESSAGE_BATCH_SIZE = 32;
         static constexpr uSize MAX_OUTPUTS_NUM = 8;
 
         PlatformFile outputs[MAX_OUTPUTS_NUM];
         ThreadSafeQueue<LogMessage>::Cell queueCells[MESSAGE_QUEUE_SIZE];
         ThreadSafeQueue<LogMessage> messageQueue;
-        Atomic<bool> isWritingToOuptuts;
+        Atomic<u32> isWritingToOuptuts;    // u32 instead of bool or u64, so threads can wait on it (address waits are 32-bit)
+        AdaptiveWait writesWait;
     };
 
     struct LoggerCreateInfo
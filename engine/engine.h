@@ -12,6 +12,7 @@
 #include "engine/platform/platform.h"
 #include "engine/render/renderer.h"
 #include "engine/thread_local_globals/thread_local_globals.h"
+#include "engine/job_system/job_system.h"
 #include "engine/application_subsystems.h"
 #include "engine/application.h"
 
@@ -23,6 +24,7 @@
 #   include "engine/platform/platform.cpp"
 #   include "engine/render/renderer.cpp"
 #   include "engine/thread_local_globals/thread_local_globals.cpp"
+#   include "engine/job_system/job_system.cpp"
 #   include "engine/application.cpp"
 #endif
 
@@ -0,0 +1,654 @@
+
+#include <cstring>
+#include <cstdio>
+
+#include "job_system.h"
+#include "engine/debug/assert.h"
+#include "engine/thread_local_globals/thread_local_globals.h"
+
+namespace al
+{
+    //
+    // Chase-Lev deque
+    //
+
+    void job_deque_construct(JobDeque* deque)
+    {
+        platform_atomic_64_bit_store(&deque->top, s64(0), MemoryOrder::RELAXED);
+        platform_atomic_64_bit_store(&deque->bottom, s64(0), MemoryOrder::RELAXED);
+        std::memset(deque->buffer, 0, sizeof(deque->buffer));
+    }
+
+    // @NOTE : can be called only by the owner of the deque
+    bool job_deque_push(JobDeque* deque, Job* job)
+    {
+        const s64 bottom = platform_atomic_64_bit_load(&deque->bottom, MemoryOrder::RELAXED);
+        const s64 top = platform_atomic_64_bit_load(&deque->top, MemoryOrder::ACQUIRE);
+        if (bottom - top >= s64(JobDeque::CAPACITY))
+        {
+            return false;
+        }
+        platform_atomic_64_bit_store(&deque->buffer[bottom & (JobDeque::CAPACITY - 1)], job, MemoryOrder::RELAXED);
+        // Release makes the job visible to thieves before the new bottom
+        platform_atomic_64_bit_store(&deque->bottom, bottom + 1, MemoryOrder::RELEASE);
+        return true;
+    }
+
+    // @NOTE : can be called only by the owner of the deque
+    Job* job_deque_pop(JobDeque* deque)
+    {
+        const s64 bottom = platform_atomic_64_bit_load(&deque->bottom, MemoryOrder::RELAXED) - 1;
+        // Bottom must be published before top is read (store-load barrier), otherwise owner and thief can take the same job.
+        // Both operations are sequentially consistent, so they can't be reordered on weakly-ordered hardware either.
+        platform_atomic_64_bit_store(&deque->bottom, bottom, MemoryOrder::SEQUENTIALLY_CONSISTENT);
+        s64 top = platform_atomic_64_bit_load(&deque->top, MemoryOrder::SEQUENTIALLY_CONSISTENT);
+        if (top > bottom)
+        {
+            // Deque is empty
+            platform_atomic_64_bit_store(&deque->bottom, bottom + 1, MemoryOrder::RELAXED);
+            return nullptr;
+        }
+        Job* job = platform_atomic_64_bit_load(&deque->buffer[bottom & (JobDeque::CAPACITY - 1)], MemoryOrder::RELAXED);
+        if (top == bottom)
+        {
+            // Last job in the deque, race with thieves for it
+            if (!platform_atomic_64_bit_cas(&deque->top, &top, top + 1, MemoryOrder::SEQUENTIALLY_CONSISTENT))
+            {
+                job = nullptr;
+            }
+            platform_atomic_64_bit_store(&deque->bottom, bottom + 1, MemoryOrder::RELAXED);
+        }
+        return job;
+    }
+
+    Job* job_deque_steal(JobDeque* deque)
+    {
+        s64 top = platform_atomic_64_bit_load(&deque->top, MemoryOrder::SEQUENTIALLY_CONSISTENT);
+        const s64 bottom = platform_atomic_64_bit_load(&deque->bottom, MemoryOrder::ACQUIRE);
+        if (top >= bottom)
+        {
+            return nullptr;
+        }
+        Job* job = platform_atomic_64_bit_load(&deque->buffer[top & (JobDeque::CAPACITY - 1)], MemoryOrder::RELAXED);
+        if (!platform_atomic_64_bit_cas(&deque->top, &top, top + 1, MemoryOrder::SEQUENTIALLY_CONSISTENT))
+        {
+            // Other thief or the owner took this job
+            return nullptr;
+        }
+        return job;
+    }
+
+    // @NOTE : result is only a hint if other threads use the deque at the same time
+    bool job_deque_is_empty(JobDeque* deque)
+    {
+        const s64 top = platform_atomic_64_bit_load(&deque->top, MemoryOrder::ACQUIRE);
+        const s64 bottom = platform_atomic_64_bit_load(&deque->bottom, MemoryOrder::ACQUIRE);
+        return top >= bottom;
+    }
+
+    //
+    // Parked fibers
+    //
+
+    void job_system_enqueue_fiber(ThreadSafeQueue<JobFiber*>* queue, JobFiber* fiber)
+    {
+        //
+        // Each fiber is in at most one list at a time and lists can hold all fibers, but enqueue can still fail for a moment :
+        // cell stays occupied until the thread which dequeued from it finishes, and this thread can be preempted.
+        // Fiber must never be lost, so enqueue is retried.
+        //
+        while (!thread_safe_queue_enqueue(queue, &fiber))
+        {
+            platform_thread_yield();
+        }
+    }
+
+    // Returns parked fiber whose counter is finished or nullptr if there is no such fiber
+    JobFiber* job_system_take_ready_fiber(JobSystem* system)
+    {
+        JobFiber* fiber;
+        if (!thread_safe_queue_dequeue(&system->waitingFibers, &fiber))
+        {
+            return nullptr;
+        }
+        if (!job_system_is_finished(fiber->waitCounter))
+        {
+            job_system_enqueue_fiber(&system->waitingFibers, fiber);
+            return nullptr;
+        }
+        fiber->waitCounter = nullptr;
+        return fiber;
+    }
+
+    // @NOTE : checks each parked fiber at most once, fibers parked during the check can be missed
+    bool job_system_has_ready_fiber(JobSystem* system)
+    {
+        for (uSize it = 0; it < system->numFibers; it++)
+        {
+            JobFiber* fiber;
+            if (!thread_safe_queue_dequeue(&system->waitingFibers, &fiber))
+            {
+                return false;
+            }
+            const bool isReady = job_system_is_finished(fiber->waitCounter);
+            job_system_enqueue_fiber(&system->waitingFibers, fiber);
+            if (isReady)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //
+    // Sleeping
+    //
+
+    //
+    // Parked fibers which still wait don't keep workers awake : whoever finishes a counter wakes sleeping workers up.
+    // Fibers and thread stacks whose counters are already finished do, because nobody will wake the workers up for them again.
+    //
+    bool job_system_has_work(JobSystem* system)
+    {
+        if (!platform_atomic_64_bit_load(&system->isRunning, MemoryOrder::ACQUIRE))
+        {
+            return true;
+        }
+        JobWorker* worker = *tls_access(&system->currentWorker);
+        if (worker && worker->threadWaitCounter && job_system_is_finished(worker->threadWaitCounter))
+        {
+            return true;
+        }
+        if (job_system_has_ready_fiber(system))
+        {
+            return true;
+        }
+        for (uSize it = 0; it < system->numWorkers; it++)
+        {
+            if (!job_deque_is_empty(&system->workers[it].deque))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Returns false if there were no sleeping workers
+    bool job_system_wake_up_worker(JobSystem* system)
+    {
+        //
+        // Compare-exchange is a full barrier, unlike plain load. It guarantees that a worker, which is about to sleep,
+        // either sees the job pushed before this call or is counted here. Exchange of 0 with 0 only reads the value.
+        //
+        u64 numSleeping = 0;
+        platform_atomic_64_bit_cas(&system->numSleepingWorkers, &numSleeping, u64(0), MemoryOrder::SEQUENTIALLY_CONSISTENT);
+        while (numSleeping > 0)
+        {
+            if (platform_atomic_64_bit_cas(&system->numSleepingWorkers, &numSleeping, numSleeping - 1, MemoryOrder::SEQUENTIALLY_CONSISTENT))
+            {
+                platform_semaphore_signal(&system->wakeUpSemaphore);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void job_system_sleep(JobSystem* system)
+    {
+        // Worker is counted as sleeping before the last check, so a job pushed after the check will wake it up
+        platform_atomic_64_bit_increment(&system->numSleepingWorkers);
+        if (job_system_has_work(system))
+        {
+            u64 numSleeping = platform_atomic_64_bit_load(&system->numSleepingWorkers, MemoryOrder::RELAXED);
+            while (numSleeping > 0)
+            {
+                if (platform_atomic_64_bit_cas(&system->numSleepingWorkers, &numSleeping, numSleeping - 1, MemoryOrder::SEQUENTIALLY_CONSISTENT))
+                {
+                    return;
+                }
+            }
+            // Somebody has already woken this worker up and signaled the semaphore, so signal must be consumed
+        }
+        platform_semaphore_wait(&system->wakeUpSemaphore);
+    }
+
+    void job_system_idle(JobSystem* system, uSize* numIdleSpins)
+    {
+        if (++(*numIdleSpins) < JobSystem::IDLE_SPINS_BEFORE_SLEEP)
+        {
+            platform_thread_yield();
+            return;
+        }
+        *numIdleSpins = 0;
+        job_system_sleep(system);
+    }
+
+    //
+    // Jobs
+    //
+
+    JobWorker* job_system_get_current_worker(JobSystem* system)
+    {
+        JobWorker* worker = *tls_access(&system->currentWorker);
+        al_assert_msg(worker, "Job system can only be used from worker threads");
+        return worker;
+    }
+
+    void job_system_execute(JobSystem* system, Job* job)
+    {
+        job->function();
+        // Captured state is destroyed before the job is marked as finished
+        job->function = Function<void()>{};
+        if (job->counter && platform_atomic_64_bit_decrement(&job->counter->value) == 0)
+        {
+            //
+            // Fibers parked on the counter can be resumed now. All sleeping workers are woken up,
+            // because parked thread stack of a worker can be resumed only by that particular worker.
+            //
+            while (job_system_wake_up_worker(system)) { }
+        }
+        platform_atomic_64_bit_store(&job->isInUse, false, MemoryOrder::RELEASE);
+    }
+
+    Job* job_system_find_job(JobWorker* worker)
+    {
+        Job* job = job_deque_pop(&worker->deque);
+        if (job)
+        {
+            return job;
+        }
+        JobSystem* system = worker->system;
+        if (system->numWorkers == 1)
+        {
+            return nullptr;
+        }
+        // xorshift picks the first victim, so idle workers don't all attack the same deque
+        worker->randomState ^= worker->randomState << 13;
+        worker->randomState ^= worker->randomState >> 7;
+        worker->randomState ^= worker->randomState << 17;
+        const uSize firstVictim = worker->randomState % system->numWorkers;
+        for (uSize it = 0; it < system->numWorkers; it++)
+        {
+            JobWorker* victim = &system->workers[(firstVictim + it) % system->numWorkers];
+            if (victim == worker)
+            {
+                continue;
+            }
+            job = job_deque_steal(&victim->deque);
+            if (job)
+            {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    bool job_system_try_execute(JobWorker* worker)
+    {
+        Job* job = job_system_find_job(worker);
+        if (job)
+        {
+            job_system_execute(worker->system, job);
+            return true;
+        }
+        return false;
+    }
+
+    //
+    // Fibers
+    //
+
+    // @NOTE :  Fiber can be parked on one worker thread and resumed on the other one,
+    //          so worker must be fetched again after every call which can execute a job or switch fibers.
+
+    // @NOTE : target == nullptr switches back to the thread fiber of the worker
+    void job_system_switch_to(JobWorker* worker, JobFiber* target, JobWorker::PreviousFiberAction action)
+    {
+        JobFiber* current = worker->currentFiber;
+        worker->previousFiber = current;
+        worker->previousFiberAction = action;
+        worker->currentFiber = target;
+        platform_fiber_switch(current ? &current->fiber : &worker->threadFiber, target ? &target->fiber : &worker->threadFiber);
+    }
+
+    // @NOTE : must be called by the fiber which was switched to before it does anything else
+    void job_system_after_switch(JobWorker* worker)
+    {
+        JobFiber* previous = worker->previousFiber;
+        const JobWorker::PreviousFiberAction action = worker->previousFiberAction;
+        worker->previousFiber = nullptr;
+        worker->previousFiberAction = JobWorker::PreviousFiberAction::NOTHING;
+        if (!previous || action == JobWorker::PreviousFiberAction::NOTHING)
+        {
+            return;
+        }
+        JobSystem* system = worker->system;
+        job_system_enqueue_fiber(action == JobWorker::PreviousFiberAction::RELEASE ? &system->freeFibers : &system->waitingFibers, previous);
+    }
+
+    bool job_system_try_resume_waiting_fiber(JobSystem* system)
+    {
+        JobFiber* fiber = job_system_take_ready_fiber(system);
+        if (!fiber)
+        {
+            return false;
+        }
+        job_system_switch_to(job_system_get_current_worker(system), fiber, JobWorker::PreviousFiberAction::RELEASE);
+        // This fiber was taken from the free list, possibly by the other worker
+        job_system_after_switch(job_system_get_current_worker(system));
+        return true;
+    }
+
+    // @NOTE :  Thread stack of a worker never leaves its thread, so it is resumed by whichever fiber runs on this worker
+    bool job_system_try_resume_thread(JobSystem* system)
+    {
+        JobWorker* worker = job_system_get_current_worker(system);
+        if (!worker->threadWaitCounter || !job_system_is_finished(worker->threadWaitCounter))
+        {
+            return false;
+        }
+        worker->threadWaitCounter = nullptr;
+        job_system_switch_to(worker, nullptr, JobWorker::PreviousFiberAction::RELEASE);
+        job_system_after_switch(job_system_get_current_worker(system));
+        return true;
+    }
+
+    //
+    // Parks current fiber (or thread stack of the worker) until the counter is finished
+    // and continues on a ready parked fiber or on a free one. Returns false if nothing could be parked.
+    //
+    bool job_system_try_park(JobSystem* system, JobCounter* counter)
+    {
+        JobWorker* worker = job_system_get_current_worker(system);
+        // Nothing is parked during shutdown, because fibers which left their loops can't resume anybody
+        if ((!worker->currentFiber && !worker->isThreadFiber) || !platform_atomic_64_bit_load(&system->isRunning, MemoryOrder::ACQUIRE))
+        {
+            return false;
+        }
+        JobFiber* next = job_system_take_ready_fiber(system);
+        if (!next && !thread_safe_queue_dequeue(&system->freeFibers, &next))
+        {
+            return false;
+        }
+        if (worker->currentFiber)
+        {
+            // Fiber is resumed only after the counter is finished, possibly on the other worker thread
+            worker->currentFiber->waitCounter = counter;
+            job_system_switch_to(worker, next, JobWorker::PreviousFiberAction::WAIT);
+        }
+        else
+        {
+            worker->threadWaitCounter = counter;
+            job_system_switch_to(worker, next, JobWorker::PreviousFiberAction::NOTHING);
+        }
+        job_system_after_switch(job_system_get_current_worker(system));
+        return true;
+    }
+
+    void job_system_fiber_main(void* userData)
+    {
+        JobFiber* self = static_cast<JobFiber*>(userData);
+        JobSystem* system = self->system;
+        job_system_after_switch(job_system_get_current_worker(system));
+        uSize numIdleSpins = 0;
+        while (platform_atomic_64_bit_load(&system->isRunning, MemoryOrder::ACQUIRE))
+        {
+            if (job_system_try_resume_thread(system) ||
+                job_system_try_resume_waiting_fiber(system) ||
+                job_system_try_execute(job_system_get_current_worker(system)))
+            {
+                numIdleSpins = 0;
+            }
+            else
+            {
+                job_system_idle(system, &numIdleSpins);
+            }
+        }
+        //
+        // Fiber function must never return, so control goes back to the worker thread.
+        // Finished fiber is not released to the free list : it would leave the loop right away if somebody switched to it.
+        //
+        job_system_switch_to(job_system_get_current_worker(system), nullptr, JobWorker::PreviousFiberAction::NOTHING);
+    }
+
+    //
+    // Workers
+    //
+
+    void job_system_worker_thread(void* userData)
+    {
+        JobWorker* worker = static_cast<JobWorker*>(userData);
+        JobSystem* system = worker->system;
+        thread_local_globals_register(system->globals);
+        *tls_access(&system->currentWorker) = worker;
+        const bool isFiber = platform_fiber_convert_current_thread(&worker->threadFiber);
+        worker->isThreadFiber = isFiber;
+        JobFiber* fiber;
+        if (isFiber && thread_safe_queue_dequeue(&system->freeFibers, &fiber))
+        {
+            job_system_switch_to(worker, fiber, JobWorker::PreviousFiberAction::NOTHING);
+            // Job system is shut down
+            job_system_after_switch(worker);
+        }
+        else
+        {
+            uSize numIdleSpins = 0;
+            while (platform_atomic_64_bit_load(&system->isRunning, MemoryOrder::ACQUIRE))
+            {
+                if (job_system_try_execute(worker))
+                {
+                    numIdleSpins = 0;
+                }
+                else
+                {
+                    job_system_idle(system, &numIdleSpins);
+                }
+            }
+        }
+        if (isFiber)
+        {
+            worker->isThreadFiber = false;
+            platform_fiber_convert_back_to_thread(&worker->threadFiber);
+        }
+    }
+
+    Job* job_system_allocate_job(JobSystem* system)
+    {
+        //
+        // Slots of unfinished jobs are skipped instead of waited for : such job can be waiting on
+        // the stack of this very thread, so waiting for it would never end.
+        // If all slots are in use, this thread helps other workers until some job is finished.
+        //
+        while (true)
+        {
+            JobWorker* worker = job_system_get_current_worker(system);
+            for (uSize it = 0; it < JobWorker::MAX_JOBS; it++)
+            {
+                Job* job = &worker->jobs[worker->nextJob++ & (JobWorker::MAX_JOBS - 1)];
+                if (!platform_atomic_64_bit_load(&job->isInUse, MemoryOrder::ACQUIRE))
+                {
+                    platform_atomic_64_bit_store(&job->isInUse, true, MemoryOrder::RELAXED);
+                    return job;
+                }
+            }
+            if (!job_system_try_execute(worker))
+            {
+                platform_thread_yield();
+            }
+        }
+    }
+
+    //
+    // Public interface
+    //
+
+    void job_system_construct(JobSystem* system, AllocatorBindings* allocator, ApplicationGlobals* globals, uSize numWorkers)
+    {
+        if (numWorkers == 0)
+        {
+            numWorkers = platform_get_logical_core_count();
+        }
+        numWorkers = numWorkers > JobSystem::MAX_WORKERS ? JobSystem::MAX_WORKERS : numWorkers;
+        system->allocator = *allocator;
+        system->globals = globals;
+        system->numWorkers = numWorkers;
+        system->workers = allocate<JobWorker>(&system->allocator, numWorkers);
+        std::memset(system->workers, 0, sizeof(JobWorker) * numWorkers);
+        tls_construct(&system->currentWorker);
+        platform_semaphore_construct(&system->wakeUpSemaphore);
+        platform_atomic_64_bit_store(&system->numSleepingWorkers, u64(0), MemoryOrder::RELAXED);
+        platform_atomic_64_bit_store(&system->isRunning, true, MemoryOrder::RELEASE);
+        for (uSize it = 0; it < numWorkers; it++)
+        {
+            JobWorker* worker = &system->workers[it];
+            job_deque_construct(&worker->deque);
+            worker->nextJob = 0;
+            worker->randomState = 0x9E3779B97F4A7C15ull * (it + 1);
+            worker->system = system;
+            worker->index = it;
+            worker->currentFiber = nullptr;
+            worker->previousFiber = nullptr;
+            worker->previousFiberAction = JobWorker::PreviousFiberAction::NOTHING;
+            worker->threadWaitCounter = nullptr;
+            worker->isThreadFiber = false;
+        }
+        system->fibers = allocate<JobFiber>(&system->allocator, JobSystem::NUM_FIBERS);
+        system->freeFiberCells = allocate<ThreadSafeQueue<JobFiber*>::Cell>(&system->allocator, JobSystem::NUM_FIBERS);
+        system->waitingFiberCells = allocate<ThreadSafeQueue<JobFiber*>::Cell>(&system->allocator, JobSystem::NUM_FIBERS);
+        thread_safe_queue_construct(&system->freeFibers, system->freeFiberCells, JobSystem::NUM_FIBERS);
+        thread_safe_queue_construct(&system->waitingFibers, system->waitingFiberCells, JobSystem::NUM_FIBERS);
+        // Single worker has nobody to wait for, so it doesn't need any fibers
+        const uSize numFibers = numWorkers > 1 ? JobSystem::NUM_FIBERS : 0;
+        for (uSize it = 0; it < numFibers; it++)
+        {
+            JobFiber* fiber = &system->fibers[it];
+            fiber->system = system;
+            fiber->waitCounter = nullptr;
+            const bool isCreated = platform_fiber_create(&fiber->fiber, JobSystem::FIBER_STACK_SIZE, job_system_fiber_main, fiber);
+            al_assert_msg(isCreated, "Unable to create job system fiber");
+            job_system_enqueue_fiber(&system->freeFibers, fiber);
+        }
+        system->numFibers = numFibers;
+        // Calling thread lends itself to fibers while it waits, but its own stack never leaves the thread
+        if (numFibers > 0)
+        {
+            system->workers[0].isThreadFiber = platform_fiber_convert_current_thread(&system->workers[0].threadFiber);
+        }
+        // Calling thread is the worker 0
+        *tls_access(&system->currentWorker) = &system->workers[0];
+        for (uSize it = 1; it < numWorkers; it++)
+        {
+            PlatformThread* thread = &system->workers[it].thread;
+            const bool isCreated = platform_thread_create(thread, job_system_worker_thread, &system->workers[it]);
+            al_assert_msg(isCreated, "Unable to create job system worker thread");
+            // Worker 0 is the calling thread, which is not pinned, so core 0 is left for it
+            platform_thread_set_affinity(thread, it);
+            char name[16];
+            std::snprintf(name, sizeof(name), "al_worker_%zu", it);
+            platform_thread_set_name(thread, name);
+        }
+    }
+
+    bool job_system_are_all_deques_empty(JobSystem* system)
+    {
+        for (uSize it = 0; it < system->numWorkers; it++)
+        {
+            if (!job_deque_is_empty(&system->workers[it].deque))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void job_system_destroy(JobSystem* system)
+    {
+        // Finish jobs left in the deques of all workers, calling thread steals them if their owners are busy
+        JobWorker* worker = job_system_get_current_worker(system);
+        while (!job_system_are_all_deques_empty(system))
+        {
+            if (!job_system_try_execute(worker))
+            {
+                platform_thread_yield();
+            }
+        }
+        platform_atomic_64_bit_store(&system->isRunning, false, MemoryOrder::SEQUENTIALLY_CONSISTENT);
+        while (job_system_wake_up_worker(system)) { }
+        for (uSize it = 1; it < system->numWorkers; it++)
+        {
+            platform_thread_join(&system->workers[it].thread);
+        }
+        // Jobs which were running on other workers could have created more jobs before those workers stopped
+        while (job_system_try_execute(worker)) { }
+        al_assert_msg(job_system_are_all_deques_empty(system), "Job system was destroyed with unfinished jobs");
+        if (worker->isThreadFiber)
+        {
+            worker->isThreadFiber = false;
+            platform_fiber_convert_back_to_thread(&worker->threadFiber);
+        }
+        for (uSize it = 0; it < system->numFibers; it++)
+        {
+            platform_fiber_destroy(&system->fibers[it].fiber);
+        }
+        thread_safe_queue_destruct(&system->freeFibers);
+        thread_safe_queue_destruct(&system->waitingFibers);
+        deallocate<ThreadSafeQueue<JobFiber*>::Cell>(&system->allocator, system->freeFiberCells, JobSystem::NUM_FIBERS);
+        deallocate<ThreadSafeQueue<JobFiber*>::Cell>(&system->allocator, system->waitingFiberCells, JobSystem::NUM_FIBERS);
+        deallocate<JobFiber>(&system->allocator, system->fibers, JobSystem::NUM_FIBERS);
+        platform_semaphore_destroy(&system->wakeUpSemaphore);
+        tls_destroy(&system->currentWorker);
+        deallocate<JobWorker>(&system->allocator, system->workers, system->numWorkers);
+    }
+
+    void job_system_run(JobSystem* system, const Function<void()>& function, JobCounter* counter)
+    {
+        Job* job = job_system_allocate_job(system);
+        // Allocation can execute other jobs, so worker is fetched after it
+        JobWorker* worker = job_system_get_current_worker(system);
+        job->function = function;
+        job->counter = counter;
+        if (counter)
+        {
+            platform_atomic_64_bit_increment(&counter->value);
+        }
+        if (job_deque_push(&worker->deque, job))
+        {
+            job_system_wake_up_worker(system);
+        }
+        else
+        {
+            // Deque is full, so job is executed right away
+            job_system_execute(system, job);
+        }
+    }
+
+    bool job_system_is_finished(JobCounter* counter)
+    {
+        return platform_atomic_64_bit_load(&counter->value, MemoryOrder::ACQUIRE) == 0;
+    }
+
+    void job_system_wait(JobSystem* system, JobCounter* counter)
+    {
+        //
+        // Current fiber is parked if there is a ready or free fiber to continue on.
+        // Otherwise (fiber pool is exhausted) worker executes other jobs and keeps trying,
+        // because the counter may depend on parked fibers which only a parking worker can resume.
+        //
+        while (!job_system_is_finished(counter))
+        {
+            if (job_system_try_park(system, counter))
+            {
+                return;
+            }
+            if (!job_system_try_execute(job_system_get_current_worker(system)))
+            {
+                platform_thread_yield();
+            }
+        }
+    }
+
+    JobSystem* job_system_access()
+    {
+        return thread_local_globals_access()->jobSystem;
+    }
+}
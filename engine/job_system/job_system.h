@@ -0,0 +1,132 @@
+#ifndef AL_JOB_SYSTEM_H
+#define AL_JOB_SYSTEM_H
+
+/*
+    Work-stealing job system.
+    Workflow is as follows:
+        JobSystem* jobSystem = thread_local_globals_access()->jobSystem;
+        JobCounter counter{ };
+        for (uSize it = 0; it < numChunks; it++)
+        {
+            job_system_run(jobSystem, [it]() { process_chunk(it); }, &counter);
+        }
+        job_system_wait(jobSystem, &counter); // executes other jobs while waiting
+
+    Implementation details:
+        - one worker per logical core. Thread which constructs the job system becomes worker 0, the rest get their own threads,
+          each pinned to its own core;
+        - each worker owns a Chase-Lev deque (https://fzn.fr/readings/ppopp13.pdf). Owner pushes and pops jobs at the bottom,
+          other workers steal from the top, so owner never contends with thieves unless deque has a single job;
+        - jobs are stored in a per-worker ring, so job creation never touches an allocator.
+          Slots of unfinished jobs are skipped, if all of them are in use creating thread executes other jobs;
+        - job counter is incremented when job is created and decremented when job is finished;
+        - worker threads execute jobs on pooled fibers. If a job waits for a counter, its fiber is parked in the waiting list
+          and the worker switches to a ready parked fiber or to a free one, which continues executing other jobs. Parked fibers
+          are resumed by any worker once their counters reach zero. Stack of worker 0 (usually the main thread) never leaves
+          its thread : while it waits, the thread runs fibers and the stack is resumed only by a fiber running on worker 0.
+          If the fiber pool is exhausted, waiting worker executes other jobs until it can park;
+        - all counters must be waited for before the job system is destroyed;
+        - worker which can't find any job for a while goes to sleep on a semaphore. Creating a job wakes one sleeping worker,
+          finishing a counter wakes all of them (fibers parked on the counter became ready).
+*/
+
+#include "engine/types.h"
+#include "engine/memory/memory.h"
+#include "engine/platform/platform.h"
+#include "engine/utilities/function.h"
+#include "engine/utilities/thread_local_storage.h"
+#include "engine/utilities/thread_safe_queue.h"
+
+namespace al
+{
+    struct ApplicationGlobals;
+    struct JobSystem;
+
+    struct JobCounter
+    {
+        Atomic<u64> value;
+    };
+
+    struct Job
+    {
+        Function<void()> function;
+        JobCounter* counter;
+        Atomic<bool> isInUse;
+    };
+
+    struct JobDeque
+    {
+        static constexpr uSize CAPACITY = 1024;
+        typedef u8 CachelinePadding[64];
+
+        Atomic<s64>         top;
+        CachelinePadding    pad0;
+        Atomic<s64>         bottom;
+        CachelinePadding    pad1;
+        Atomic<Job*>        buffer[CAPACITY];
+    };
+
+    struct JobFiber
+    {
+        PlatformFiber fiber;
+        JobSystem* system;
+        JobCounter* waitCounter;
+    };
+
+    struct JobWorker
+    {
+        // Fiber which was switched from can't be used by other workers until the switch is complete,
+        // so it is put to the free or waiting list by the fiber which was switched to
+        enum struct PreviousFiberAction : u8
+        {
+            NOTHING,
+            RELEASE,
+            WAIT,
+        };
+        static constexpr uSize MAX_JOBS = JobDeque::CAPACITY;
+        JobDeque deque;
+        Job jobs[MAX_JOBS];
+        u64 nextJob;
+        u64 randomState;
+        JobSystem* system;
+        uSize index;
+        PlatformThread thread;
+        PlatformFiber threadFiber;
+        JobFiber* currentFiber;     // nullptr if worker runs on its thread stack
+        JobFiber* previousFiber;
+        PreviousFiberAction previousFiberAction;
+        JobCounter* threadWaitCounter;  // set while thread stack of this worker is parked
+        bool isThreadFiber;             // thread was converted to a fiber, so its stack can be parked
+    };
+
+    struct JobSystem
+    {
+        static constexpr uSize MAX_WORKERS = 64;
+        static constexpr uSize NUM_FIBERS = 128;    // must be a power of two
+        static constexpr uSize FIBER_STACK_SIZE = 256 * 1024;
+        static constexpr uSize IDLE_SPINS_BEFORE_SLEEP = 64;
+        AllocatorBindings allocator;
+        ApplicationGlobals* globals;
+        JobWorker* workers;
+        uSize numWorkers;
+        Atomic<bool> isRunning;
+        ThreadLocalStorage<JobWorker*, MAX_WORKERS> currentWorker;
+        JobFiber* fibers;
+        uSize numFibers;
+        ThreadSafeQueue<JobFiber*>::Cell* freeFiberCells;
+        ThreadSafeQueue<JobFiber*>::Cell* waitingFiberCells;
+        ThreadSafeQueue<JobFiber*> freeFibers;
+        ThreadSafeQueue<JobFiber*> waitingFibers;
+        PlatformSemaphore wakeUpSemaphore;
+        Atomic<u64> numSleepingWorkers;
+    };
+
+    void        job_system_construct    (JobSystem* system, AllocatorBindings* allocator, ApplicationGlobals* globals, uSize numWorkers = 0);
+    void        job_system_destroy      (JobSystem* system);
+    void        job_system_run          (JobSystem* system, const Function<void()>& function, JobCounter* counter = nullptr);
+    void        job_system_wait         (JobSystem* system, JobCounter* counter);
+    bool        job_system_is_finished  (JobCounter* counter);
+    JobSystem*  job_system_access       ();
+}
+
+#endif
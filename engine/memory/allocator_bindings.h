@@ -9,6 +9,9 @@ namespace al
     {
         void* (*allocate)(void* allocator, uSize memorySizeBytes, uSize alignmentBytes);
         void (*deallocate)(void* allocator, void* ptr, uSize memorySizeBytes);
+        // Resizes allocation in place if possible, otherwise moves it to a new allocation.
+        // Returns nullptr and keeps ptr valid if there is not enough memory
+        void* (*reallocate)(void* allocator, void* ptr, uSize oldMemorySizeBytes, uSize newMemorySizeBytes, uSize alignmentBytes);
         void* allocator;
     };
 }
@@ -3,7 +3,12 @@
 #include <cstdlib>
 #include <algorithm>
 
+#ifdef __AVX2__
+#   include <immintrin.h>
+#endif
+
 #include "memory.h"
+#include "engine/utilities/bits.h"
 
 namespace al
 {
@@ -20,12 +25,27 @@ namespace al
         return reinterpret_cast<T*>(alignedPtr);
     }
 
+    constexpr uSize align_size(uSize size, uSize alignment)
+    {
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+
     AllocatorBindings get_system_allocator_bindings()
     {
         return
         {
             .allocate = [](void* allocator, uSize size, uSize alignment){ return al_aligned_system_malloc(size, alignment); },
             .deallocate = [](void* allocator, void* ptr, uSize size){ al_aligned_system_free(ptr); },
+            .reallocate = [](void* allocator, void* ptr, uSize oldSize, uSize newSize, uSize alignment)
+            {
+                void* result = al_aligned_system_malloc(newSize, alignment);
+                if (result && ptr)
+                {
+                    std::memcpy(result, ptr, std::min(oldSize, newSize));
+                    al_aligned_system_free(ptr);
+                }
+                return result;
+            },
             .allocator = nullptr
         };
     }
@@ -57,6 +77,33 @@ namespace al
         }
     }
 
+    template<typename T>
+    T* reallocate(AllocatorBindings* bindings, T* ptr, uSize oldAmount, uSize newAmount, uSize alignment)
+    {
+        al_check_alignment(alignment);
+        if constexpr (std::is_same_v<T, void>)
+        {
+            return bindings->reallocate(bindings->allocator, ptr, oldAmount, newAmount, alignment);
+        }
+        else
+        {
+            return (T*)reallocate<void>(bindings, ptr, oldAmount * sizeof(T), newAmount * sizeof(T), alignment);
+        }
+    }
+
+    template<typename Allocator>
+    void* reallocate_by_moving(Allocator* allocator, void* ptr, uSize oldMemorySizeBytes, uSize newMemorySizeBytes, uSize alignment)
+    {
+        // Fallback for allocations which can't be resized in place
+        void* result = allocate(allocator, newMemorySizeBytes, alignment);
+        if (result && ptr)
+        {
+            std::memcpy(result, ptr, std::min(oldMemorySizeBytes, newMemorySizeBytes));
+            deallocate(allocator, ptr, oldMemorySizeBytes);
+        }
+        return result;
+    }
+
     template<typename Allocator>
     AllocatorBindings get_allocator_bindings(Allocator* _allocator)
     {
@@ -66,24 +113,116 @@ namespace al
             {
                 .allocate = [](void* allocator, uSize size, uSize alignment){ return allocate(static_cast<StackAllocator*>(allocator), size, alignment); },
                 .deallocate = [](void* allocator, void* ptr, uSize size){ deallocate(static_cast<StackAllocator*>(allocator), ptr, size); },
+                .reallocate = [](void* allocator, void* ptr, uSize oldSize, uSize newSize, uSize alignment){ return reallocate(static_cast<StackAllocator*>(allocator), ptr, oldSize, newSize, alignment); },
                 .allocator = _allocator
             };
         }
-        else
+        else if constexpr (std::is_same_v<Allocator, PoolAllocator>)
         {
             return
             {
                 .allocate = [](void* allocator, uSize size, uSize alignment){ return allocate(static_cast<PoolAllocator*>(allocator), size, alignment); },
                 .deallocate = [](void* allocator, void* ptr, uSize size){ deallocate(static_cast<PoolAllocator*>(allocator), ptr, size); },
+                .reallocate = [](void* allocator, void* ptr, uSize oldSize, uSize newSize, uSize alignment){ return reallocate(static_cast<PoolAllocator*>(allocator), ptr, oldSize, newSize, alignment); },
                 .allocator = _allocator
             };
         }
+        else if constexpr (std::is_same_v<Allocator, TaggedAllocator>)
+        {
+            return
+            {
+                .allocate = [](void* allocator, uSize size, uSize alignment){ return allocate(static_cast<TaggedAllocator*>(allocator), size, alignment); },
+                .deallocate = [](void* allocator, void* ptr, uSize size){ deallocate(static_cast<TaggedAllocator*>(allocator), ptr, size); },
+                .reallocate = [](void* allocator, void* ptr, uSize oldSize, uSize newSize, uSize alignment){ return reallocate(static_cast<TaggedAllocator*>(allocator), ptr, oldSize, newSize, alignment); },
+                .allocator = _allocator
+            };
+        }
+        else
+        {
+            static_assert(std::is_same_v<Allocator, TlsfAllocator>, "Unsupported allocator type");
+            return
+            {
+                .allocate = [](void* allocator, uSize size, uSize alignment){ return allocate(static_cast<TlsfAllocator*>(allocator), size, alignment); },
+                .deallocate = [](void* allocator, void* ptr, uSize size){ deallocate(static_cast<TlsfAllocator*>(allocator), ptr, size); },
+                .reallocate = [](void* allocator, void* ptr, uSize oldSize, uSize newSize, uSize alignment){ return reallocate(static_cast<TlsfAllocator*>(allocator), ptr, oldSize, newSize, alignment); },
+                .allocator = _allocator
+            };
+        }
+    }
+
+    void allocator_statistics_on_allocate(AllocatorStatistics* stats, uSize memorySizeBytes)
+    {
+        platform_atomic_64_bit_increment(&stats->numAllocations);
+        allocator_statistics_on_reallocate(stats, 0, memorySizeBytes);
+    }
+
+    void allocator_statistics_on_reallocate(AllocatorStatistics* stats, uSize oldMemorySizeBytes, uSize newMemorySizeBytes)
+    {
+        u64 liveBytes = platform_atomic_64_bit_add(&stats->liveBytes, u64(newMemorySizeBytes) - u64(oldMemorySizeBytes));
+        u64 peakBytes = platform_atomic_64_bit_load(&stats->peakBytes, MemoryOrder::RELAXED);
+        while (liveBytes > peakBytes)
+        {
+            if (platform_atomic_64_bit_cas(&stats->peakBytes, &peakBytes, liveBytes, MemoryOrder::RELAXED))
+            {
+                break;
+            }
+        }
+    }
+
+    void allocator_statistics_on_deallocate(AllocatorStatistics* stats, uSize memorySizeBytes)
+    {
+        platform_atomic_64_bit_increment(&stats->numDeallocations);
+        platform_atomic_64_bit_add(&stats->liveBytes, u64(0) - u64(memorySizeBytes));
+    }
+
+    void allocator_statistics_reset_live(AllocatorStatistics* stats)
+    {
+        platform_atomic_64_bit_store(&stats->liveBytes, u64(0), MemoryOrder::RELAXED);
+    }
+
+    void construct(TaggedAllocator* allocator, AllocatorBindings* bindings, const char* tag)
+    {
+        allocator->bindings = *bindings;
+        allocator->tag = tag;
+        std::memset(&allocator->stats, 0, sizeof(AllocatorStatistics));
+    }
+
+    void* allocate(TaggedAllocator* allocator, uSize memorySizeBytes, uSize alignment)
+    {
+        void* result = allocate(&allocator->bindings, memorySizeBytes, alignment);
+        al_memory_stats(if (result) allocator_statistics_on_allocate(&allocator->stats, memorySizeBytes));
+        return result;
+    }
+
+    void deallocate(TaggedAllocator* allocator, void* ptr, uSize memorySizeBytes)
+    {
+        deallocate(&allocator->bindings, ptr, memorySizeBytes);
+        al_memory_stats(allocator_statistics_on_deallocate(&allocator->stats, memorySizeBytes));
+    }
+
+    void* reallocate(TaggedAllocator* allocator, void* ptr, uSize oldMemorySizeBytes, uSize newMemorySizeBytes, uSize alignment)
+    {
+        void* result = reallocate(&allocator->bindings, ptr, oldMemorySizeBytes, newMemorySizeBytes, alignment);
+        al_memory_stats(if (result) allocator_statistics_on_reallocate(&allocator->stats, oldMemorySizeBytes, newMemorySizeBytes));
+        return result;
     }
 
     void stack_alloactor_reset(StackAllocator* stack)
     {
-        // @TODO : make this thread-safe
-        stack->top = stack->memory;
+        // Commit limit is lowered and pages are decommited before the new top is published,
+        // so allocations made from the new top always see the commit limit which is actually valid
+        if (stack->isVirtual)
+        {
+            u8* highWaterMark = static_cast<u8*>(stack->memory) + stack->highWaterMarkBytes;
+            u8* commitLimit = static_cast<u8*>(platform_atomic_64_bit_load(&stack->commitLimit, MemoryOrder::ACQUIRE));
+            if (commitLimit > highWaterMark)
+            {
+                platform_atomic_64_bit_store(&stack->commitLimit, static_cast<void*>(highWaterMark), MemoryOrder::RELEASE);
+                platform_memory_decommit(highWaterMark, commitLimit - highWaterMark);
+            }
+        }
+        al_memory_stats(allocator_statistics_reset_live(&stack->stats));
+        platform_atomic_64_bit_store(&stack->top, stack->memory, MemoryOrder::RELEASE);
     }
 
     void construct(StackAllocator* stack, uSize memorySizeBytes, AllocatorBindings* bindings)
@@ -91,52 +230,165 @@ namespace al
         stack->bindings = *bindings;
         stack->memory = allocate(bindings, memorySizeBytes, EngineConfig::MAX_MEMORY_ALIGNMENT);
         stack->memoryLimit = static_cast<u8*>(stack->memory) + memorySizeBytes;
-        stack->top = stack->memory;
+        platform_atomic_64_bit_store(&stack->top, stack->memory, MemoryOrder::RELAXED);
+        platform_atomic_64_bit_store(&stack->commitLimit, stack->memoryLimit, MemoryOrder::RELAXED);
+        stack->highWaterMarkBytes = memorySizeBytes;
+        stack->pageSizeBytes = 0;
+        stack->isVirtual = false;
+        std::memset(&stack->stats, 0, sizeof(AllocatorStatistics));
+    }
+
+    void construct_virtual(StackAllocator* stack, uSize reserveSizeBytes, uSize highWaterMarkBytes)
+    {
+        stack->bindings = { };
+        stack->pageSizeBytes = platform_memory_get_page_size();
+        stack->memory = platform_memory_reserve(align_size(reserveSizeBytes, stack->pageSizeBytes));
+        al_assert_msg(stack->memory, "Unable to reserve virtual memory for stack allocator");
+        stack->memoryLimit = static_cast<u8*>(stack->memory) + reserveSizeBytes;
+        stack->highWaterMarkBytes = std::min(align_size(highWaterMarkBytes, stack->pageSizeBytes), reserveSizeBytes);
+        stack->isVirtual = true;
+        platform_atomic_64_bit_store(&stack->top, stack->memory, MemoryOrder::RELAXED);
+        platform_atomic_64_bit_store(&stack->commitLimit, stack->memory, MemoryOrder::RELAXED);
+        std::memset(&stack->stats, 0, sizeof(AllocatorStatistics));
     }
 
     void destruct(StackAllocator* stack)
     {
         uSize stackSize = static_cast<u8*>(stack->memoryLimit) - static_cast<u8*>(stack->memory);
-        stack->bindings.deallocate(stack->bindings.allocator, stack->memory, stackSize);
+        if (stack->isVirtual)
+        {
+            platform_memory_release(stack->memory, stackSize);
+        }
+        else
+        {
+            stack->bindings.deallocate(stack->bindings.allocator, stack->memory, stackSize);
+        }
+    }
+
+    bool stack_allocator_commit(StackAllocator* stack, u8* to)
+    {
+        // Memory before commitLimit is always commited. Each thread commits everything from the commitLimit it
+        // has seen up to the required address, so commitLimit never skips pages that weren't commited yet.
+        // Commit is idempotent, so threads which race here can safely commit overlapping ranges.
+        void* currentLimit = platform_atomic_64_bit_load(&stack->commitLimit, MemoryOrder::ACQUIRE);
+        if (to <= static_cast<u8*>(currentLimit))
+        {
+            return true;
+        }
+        u8* commitFrom = static_cast<u8*>(currentLimit);
+        u8* commitTo = std::min(align_pointer(to, stack->pageSizeBytes), static_cast<u8*>(stack->memoryLimit));
+        if (!platform_memory_commit(commitFrom, commitTo - commitFrom))
+        {
+            return false;
+        }
+        while (static_cast<u8*>(currentLimit) < commitTo)
+        {
+            if (platform_atomic_64_bit_cas(&stack->commitLimit, &currentLimit, static_cast<void*>(commitTo), MemoryOrder::ACQUIRE_RELEASE))
+            {
+                break;
+            }
+        }
+        return true;
     }
 
     void* allocate(StackAllocator* stack, uSize memorySizeBytes, uSize alignment)
     {
         al_check_alignment(alignment);
-        // @TODO :  add platform atomic operations
-#if 0
-        void* result = nullptr;
+        u8* memoryLimit = static_cast<u8*>(stack->memoryLimit);
+        void* currentTop = platform_atomic_64_bit_load(&stack->top, MemoryOrder::ACQUIRE);
         while (true)
         {
-            void* currentTop = std::atomic_load_explicit(&stack->top, std::memory_order_relaxed);
-            u8* currentTopAligned = align_pointer(static_cast<u8*>(currentTop), alignment);
-            if ((static_cast<u8*>(stack->memoryLimit) - currentTopAligned) < memorySizeBytes)
+            // Header with the padding size is placed right before the allocation
+            u8* currentTopAligned = align_pointer(static_cast<u8*>(currentTop) + sizeof(StackAllocator::Header), alignment);
+            if (currentTopAligned > memoryLimit || uSize(memoryLimit - currentTopAligned) < memorySizeBytes)
             {
-                break;
+                return nullptr;
             }
-            u8* newTop = currentTopAligned + memorySizeBytes;
-            const bool casResult = std::atomic_compare_exchange_strong(&stack->top, &currentTop, newTop);
-            if (casResult)
+            void* newTop = currentTopAligned + memorySizeBytes;
+            // If cas fails, currentTop is updated with the actual top value, so we just try again
+            if (platform_atomic_64_bit_cas(&stack->top, &currentTop, newTop, MemoryOrder::ACQUIRE_RELEASE))
             {
-                result = currentTopAligned;
-                break;
+                if (stack->isVirtual && !stack_allocator_commit(stack, static_cast<u8*>(newTop)))
+                {
+                    // Top is rolled back unless somebody has already allocated after it
+                    platform_atomic_64_bit_cas(&stack->top, &newTop, currentTop, MemoryOrder::ACQUIRE_RELEASE);
+                    return nullptr;
+                }
+                const StackAllocator::Header padding = StackAllocator::Header(currentTopAligned - static_cast<u8*>(currentTop));
+                std::memcpy(currentTopAligned - sizeof(StackAllocator::Header), &padding, sizeof(StackAllocator::Header));
+                // Alignment padding is accounted as well, so marker rollback releases exactly what was allocated
+                al_memory_stats(allocator_statistics_on_allocate(&stack->stats, static_cast<u8*>(newTop) - static_cast<u8*>(currentTop)));
+                return currentTopAligned;
             }
         }
-        return result;
-#else
-        u8* currentTopAligned = align_pointer(static_cast<u8*>(stack->top), alignment);
-        if ((static_cast<u8*>(stack->memoryLimit) - currentTopAligned) < memorySizeBytes)
+    }
+
+    void deallocate(StackAllocator* stack, void* ptr, uSize memorySizeBytes)
+    {
+        // Only the most recent allocation can be returned to the stack. If top has moved since (or another
+        // thread moves it concurrently) cas fails and memory is released on the next reset or marker restore.
+        // Top goes back to where it was before the alignment padding, so a chain of LIFO deallocations unwinds fully.
+        StackAllocator::Header padding;
+        std::memcpy(&padding, static_cast<u8*>(ptr) - sizeof(StackAllocator::Header), sizeof(StackAllocator::Header));
+        void* expectedTop = static_cast<u8*>(ptr) + memorySizeBytes;
+        if (platform_atomic_64_bit_cas(&stack->top, &expectedTop, static_cast<void*>(static_cast<u8*>(ptr) - padding), MemoryOrder::ACQUIRE_RELEASE))
         {
-            return nullptr;
+            al_memory_stats(allocator_statistics_on_deallocate(&stack->stats, memorySizeBytes + padding));
         }
-        stack->top = currentTopAligned + memorySizeBytes;
-        return currentTopAligned;
-#endif
     }
 
-    void deallocate(StackAllocator* stack, void* ptr, uSize memorySizeBytes)
+    void* reallocate(StackAllocator* stack, void* ptr, uSize oldMemorySizeBytes, uSize newMemorySizeBytes, uSize alignment)
+    {
+        // The most recent allocation is resized by moving top. Any other allocation can only shrink in place
+        al_check_alignment(alignment);
+        if (!ptr || (reinterpret_cast<uPtr>(ptr) & (alignment - 1)))
+        {
+            return reallocate_by_moving(stack, ptr, oldMemorySizeBytes, newMemorySizeBytes, alignment);
+        }
+        u8* bytePtr = static_cast<u8*>(ptr);
+        void* expectedTop = bytePtr + oldMemorySizeBytes;
+        if (newMemorySizeBytes <= uSize(static_cast<u8*>(stack->memoryLimit) - bytePtr) &&
+            platform_atomic_64_bit_cas(&stack->top, &expectedTop, static_cast<void*>(bytePtr + newMemorySizeBytes), MemoryOrder::ACQUIRE_RELEASE))
+        {
+            if (stack->isVirtual && !stack_allocator_commit(stack, bytePtr + newMemorySizeBytes))
+            {
+                // Top is rolled back unless somebody has already allocated after it
+                void* newTop = bytePtr + newMemorySizeBytes;
+                platform_atomic_64_bit_cas(&stack->top, &newTop, static_cast<void*>(bytePtr + oldMemorySizeBytes), MemoryOrder::ACQUIRE_RELEASE);
+                return nullptr;
+            }
+            al_memory_stats(allocator_statistics_on_reallocate(&stack->stats, oldMemorySizeBytes, newMemorySizeBytes));
+            return ptr;
+        }
+        if (newMemorySizeBytes <= oldMemorySizeBytes)
+        {
+            return ptr;
+        }
+        return reallocate_by_moving(stack, ptr, oldMemorySizeBytes, newMemorySizeBytes, alignment);
+    }
+
+    StackAllocatorMarker stack_allocator_get_marker(StackAllocator* stack)
     {
-        // nothing
+        return platform_atomic_64_bit_load(&stack->top, MemoryOrder::ACQUIRE);
+    }
+
+    void stack_allocator_restore_marker(StackAllocator* stack, StackAllocatorMarker marker)
+    {
+        al_assert_msg(marker >= stack->memory && marker <= stack->memoryLimit, "Marker does not belong to this stack allocator");
+        [[maybe_unused]] void* currentTop = platform_atomic_64_bit_load(&stack->top, MemoryOrder::ACQUIRE);
+        al_assert_msg(marker <= currentTop, "Stack allocator was rolled back past the marker");
+        al_memory_stats(allocator_statistics_on_deallocate(&stack->stats, static_cast<u8*>(currentTop) - static_cast<u8*>(marker)));
+        platform_atomic_64_bit_store(&stack->top, marker, MemoryOrder::RELEASE);
+    }
+
+    StackAllocatorScope::StackAllocatorScope(StackAllocator* stack)
+        : stack{ stack }
+        , marker{ stack_allocator_get_marker(stack) }
+    { }
+
+    StackAllocatorScope::~StackAllocatorScope()
+    {
+        stack_allocator_restore_marker(stack, marker);
     }
 
     template<uSize SizeBytes>
@@ -168,43 +420,165 @@ namespace al
         return { blockSizeBytes, memorySizeBytes / blockSizeBytes };
     }
 
-    void memory_bucket_construct(PoolAllocatorMemoryBucket* bucket, uSize blockSizeBytes, uSize blockCount, AllocatorBindings* bindings)
+    void memory_bucket_construct(PoolAllocatorMemoryBucket* bucket, uSize blockSizeBytes, uSize blockCount, void* memory, AllocatorBindings* bindings)
     {
-        bucket->blockSizeBytes  = blockSizeBytes;
-        bucket->blockCount      = blockCount;
-        bucket->memorySizeBytes = blockSizeBytes * blockCount;
-        bucket->ledgerSizeBytes = 1 + ((blockCount - 1) / 8);
-        bucket->memory          = allocate(bindings, bucket->memorySizeBytes, EngineConfig::MAX_MEMORY_ALIGNMENT);
-        bucket->ledger          = allocate(bindings, bucket->ledgerSizeBytes);
-        std::memset(bucket->ledger, 0, bucket->ledgerSizeBytes);
+        bucket->blockSizeBytes     = blockSizeBytes;
+        bucket->blockCount         = blockCount;
+        bucket->memorySizeBytes    = blockSizeBytes * blockCount;
+        bucket->ledgerSizeWords    = 1 + ((blockCount - 1) / 64);
+        bucket->memory             = memory;
+        bucket->ledger             = allocate<u64>(bindings, bucket->ledgerSizeWords);
+        bucket->freeListHead       = nullptr;
+        bucket->freeListSize       = 0;
+        bucket->firstFreeBlockHint = 0;
+        bucket->usedBlocks         = 0;
+        spin_lock_construct(&bucket->lock);
+        std::memset(bucket->ledger, 0, bucket->ledgerSizeWords * sizeof(u64));
+        // Mark non-existing blocks of the last ledger word as used
+        const uSize tailBits = blockCount % 64;
+        if (tailBits)
+        {
+            bucket->ledger[bucket->ledgerSizeWords - 1] = ~((u64(1) << tailBits) - 1);
+        }
     }
 
     void memory_bucket_destruct(PoolAllocatorMemoryBucket* bucket, AllocatorBindings* bindings)
     {
-        deallocate(bindings, bucket->memory, bucket->memorySizeBytes);
-        deallocate(bindings, bucket->ledger, bucket->ledgerSizeBytes);
+        deallocate<u64>(bindings, bucket->ledger, bucket->ledgerSizeWords);
     }
 
     void* memory_bucket_allocate(PoolAllocatorMemoryBucket* bucket, uSize memorySizeBytes, uSize alignment)
     {
         al_check_alignment(alignment);
-        // std::lock_guard<std::mutex> lock{ bucket->memoryMutex };
         uSize blockNum = 1 + ((memorySizeBytes - 1) / bucket->blockSizeBytes);
+        memory_bucket_lock(bucket);
+        if (blockNum == 1 && bucket->freeListHead && memory_bucket_alignment_step(bucket, alignment) == 1)
+        {
+            void* result = bucket->freeListHead;
+            bucket->freeListHead = *static_cast<void**>(result);
+            bucket->freeListSize -= 1;
+            al_memory_stats(bucket->usedBlocks += 1);
+            memory_bucket_unlock(bucket);
+            return result;
+        }
         uSize blockId = memory_bucket_find_contiguous_blocks(bucket, blockNum, alignment);
+        if (blockId == bucket->blockCount && bucket->freeListHead)
+        {
+            memory_bucket_flush_free_list(bucket);
+            blockId = memory_bucket_find_contiguous_blocks(bucket, blockNum, alignment);
+        }
         if (blockId == bucket->blockCount)
         {
+            memory_bucket_unlock(bucket);
             return nullptr;
         }
         memory_bucket_set_blocks_in_use(bucket, blockId, blockNum);
+        al_memory_stats(bucket->usedBlocks += blockNum);
+        memory_bucket_unlock(bucket);
         return static_cast<u8*>(bucket->memory) + blockId * bucket->blockSizeBytes;
     }
 
     void memory_bucket_deallocate(PoolAllocatorMemoryBucket* bucket, void* ptr, uSize memorySizeBytes)
     {
-        // std::lock_guard<std::mutex> lock{ bucket->memoryMutex };
         uSize blockNum = 1 + ((memorySizeBytes - 1) / bucket->blockSizeBytes);
-        uSize blockId = (static_cast<u8*>(ptr) - static_cast<u8*>(bucket->memory)) / bucket->blockSizeBytes;
-        memory_bucket_set_blocks_free(bucket, blockId, blockNum);
+        memory_bucket_lock(bucket);
+        al_memory_stats(bucket->usedBlocks -= blockNum);
+        if (blockNum == 1 && bucket->blockSizeBytes >= sizeof(void*))
+        {
+            *static_cast<void**>(ptr) = bucket->freeListHead;
+            bucket->freeListHead = ptr;
+            bucket->freeListSize += 1;
+        }
+        else
+        {
+            uSize blockId = (static_cast<u8*>(ptr) - static_cast<u8*>(bucket->memory)) / bucket->blockSizeBytes;
+            memory_bucket_set_blocks_free(bucket, blockId, blockNum);
+        }
+        memory_bucket_unlock(bucket);
+    }
+
+    void memory_bucket_flush_free_list(PoolAllocatorMemoryBucket* bucket)
+    {
+        while (bucket->freeListHead)
+        {
+            void* block = bucket->freeListHead;
+            bucket->freeListHead = *static_cast<void**>(block);
+            uSize blockId = (static_cast<u8*>(block) - static_cast<u8*>(bucket->memory)) / bucket->blockSizeBytes;
+            memory_bucket_set_blocks_free(bucket, blockId, 1);
+        }
+        bucket->freeListSize = 0;
+    }
+
+    void memory_bucket_lock(PoolAllocatorMemoryBucket* bucket)
+    {
+        spin_lock_lock(&bucket->lock);
+    }
+
+    void memory_bucket_unlock(PoolAllocatorMemoryBucket* bucket)
+    {
+        spin_lock_unlock(&bucket->lock);
+    }
+
+    void memory_bucket_refill_thread_cache(PoolAllocatorMemoryBucket* bucket, PoolAllocatorThreadCacheBin* bin, uSize number)
+    {
+        // Blocks are taken from the free list first and then from the ledger, in runs of contiguous free blocks
+        memory_bucket_lock(bucket);
+        uSize taken = 0;
+        while (taken < number && bucket->freeListHead)
+        {
+            void* block = bucket->freeListHead;
+            bucket->freeListHead = *static_cast<void**>(block);
+            *static_cast<void**>(block) = bin->head;
+            bin->head = block;
+            taken += 1;
+        }
+        bucket->freeListSize -= taken;
+        uSize currentBlockId = bucket->firstFreeBlockHint;
+        while (taken < number)
+        {
+            const uSize firstFreeBlockId = memory_bucket_find_free_block(bucket, currentBlockId);
+            if (firstFreeBlockId == bucket->blockCount)
+            {
+                currentBlockId = bucket->blockCount;
+                break;
+            }
+            const uSize firstUsedBlockId = memory_bucket_find_used_block(bucket, firstFreeBlockId);
+            const uSize runSize = std::min(firstUsedBlockId - firstFreeBlockId, number - taken);
+            memory_bucket_set_blocks_in_use(bucket, firstFreeBlockId, runSize);
+            for (uSize it = 0; it < runSize; it++)
+            {
+                void* block = static_cast<u8*>(bucket->memory) + (firstFreeBlockId + it) * bucket->blockSizeBytes;
+                *static_cast<void**>(block) = bin->head;
+                bin->head = block;
+            }
+            taken += runSize;
+            currentBlockId = firstFreeBlockId + runSize;
+        }
+        // Everything the scan has passed is in use now, so the next refill continues from here
+        bucket->firstFreeBlockHint = currentBlockId;
+        bin->size += taken;
+        al_memory_stats(bucket->usedBlocks += taken);
+        memory_bucket_unlock(bucket);
+    }
+
+    void memory_bucket_drain_thread_cache(PoolAllocatorMemoryBucket* bucket, PoolAllocatorThreadCacheBin* bin, uSize number)
+    {
+        // Detach first "number" blocks of the cache outside of the lock and splice them into the bucket free list
+        al_assert(number && number <= bin->size);
+        void* first = bin->head;
+        void* last = first;
+        for (uSize it = 1; it < number; it++)
+        {
+            last = *static_cast<void**>(last);
+        }
+        bin->head = *static_cast<void**>(last);
+        bin->size -= number;
+        memory_bucket_lock(bucket);
+        *static_cast<void**>(last) = bucket->freeListHead;
+        bucket->freeListHead = first;
+        bucket->freeListSize += number;
+        al_memory_stats(bucket->usedBlocks -= number);
+        memory_bucket_unlock(bucket);
     }
 
     bool memory_bucket_is_belongs(PoolAllocatorMemoryBucket* bucket, void* ptr)
@@ -214,90 +588,167 @@ namespace al
         return (bytePtr >= byteMem) && (bytePtr < (byteMem + bucket->memorySizeBytes));
     }
 
-    uSize memory_bucket_find_contiguous_blocks(PoolAllocatorMemoryBucket* bucket, uSize number, uSize alignment)
+    uSize memory_bucket_find_free_block(PoolAllocatorMemoryBucket* bucket, uSize from)
     {
-        auto isBitSet = [](u8 value, uSize bit) -> u8 { return ((value >> bit) & 1) == 1; };
-        uSize blockCounter = 0;   // contains the number of contiguous free blocks
-        uSize currentBlockId = 0; // contains id of current block
-        uSize firstBlockId = 0;   // contains id of the first block in the group of contiguous free blocks
-        for (uSize it = 0; it < bucket->ledgerSizeBytes; it++)
+        // Returns the id of the first free block starting from "from" or blockCount if there is no such block
+        if (from >= bucket->blockCount)
         {
-            u8 ledgerByte = *(static_cast<u8*>(bucket->ledger) + it);
-            if (ledgerByte == 255)
-            {
-                // Small optimization. We don't need to check byte if is already full.
-                blockCounter = 0;
-                currentBlockId += 8;
-                continue;
-            }
-            for (uSize byteIt = 0; byteIt < 8; byteIt++)
+            return bucket->blockCount;
+        }
+        uSize wordId = from / 64;
+        u64 freeBits = ~bucket->ledger[wordId] & (~u64(0) << (from % 64));
+        while (!freeBits)
+        {
+            wordId += 1;
+#ifdef __AVX2__
+            // Skip fully used words four at a time
+            const __m256i fullWord = _mm256_set1_epi64x(-1);
+            while ((wordId + 4) <= bucket->ledgerSizeWords)
             {
-                if (isBitSet(ledgerByte, byteIt))
-                {
-                    blockCounter = 0;
-                }
-                else
+                __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&bucket->ledger[wordId]));
+                if (_mm256_movemask_epi8(_mm256_cmpeq_epi64(words, fullWord)) != -1)
                 {
-                    if (blockCounter == 0)
-                    {
-                        uPtr currentBlockAddress = reinterpret_cast<uPtr>(bucket->memory) + (it * 8 + byteIt) * bucket->blockSizeBytes;
-                        bool isCorrectFirstBlock = (currentBlockAddress % alignment) == 0;
-                        if (isCorrectFirstBlock)
-                        {
-                            firstBlockId = currentBlockId;
-                            blockCounter++;
-                        }
-                    }
-                    else
-                    {
-                        blockCounter++;
-                    }
+                    break;
                 }
-                currentBlockId++;
-                if (blockCounter == number)
+                wordId += 4;
+            }
+#endif
+            if (wordId >= bucket->ledgerSizeWords)
+            {
+                return bucket->blockCount;
+            }
+            freeBits = ~bucket->ledger[wordId];
+        }
+        return wordId * 64 + count_trailing_zeros(freeBits);
+    }
+
+    uSize memory_bucket_find_used_block(PoolAllocatorMemoryBucket* bucket, uSize from)
+    {
+        // Returns the id of the first used block starting from "from" or blockCount if there is no such block
+        if (from >= bucket->blockCount)
+        {
+            return bucket->blockCount;
+        }
+        uSize wordId = from / 64;
+        u64 usedBits = bucket->ledger[wordId] & (~u64(0) << (from % 64));
+        while (!usedBits)
+        {
+            wordId += 1;
+#ifdef __AVX2__
+            // Skip fully free words four at a time
+            while ((wordId + 4) <= bucket->ledgerSizeWords)
+            {
+                __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&bucket->ledger[wordId]));
+                if (!_mm256_testz_si256(words, words))
                 {
-                    goto block_found;
+                    break;
                 }
+                wordId += 4;
+            }
+#endif
+            if (wordId >= bucket->ledgerSizeWords)
+            {
+                return bucket->blockCount;
             }
+            usedBits = bucket->ledger[wordId];
         }
-        // if nothing was found set firstBlockId to blockCount - this indicates failure of method
-        firstBlockId = bucket->blockCount;
-        block_found:
-        return firstBlockId;
+        // Tail bits of the last word are always set, so result is clamped to blockCount
+        return std::min(wordId * 64 + count_trailing_zeros(usedBits), bucket->blockCount);
     }
 
-    void memory_bucket_set_blocks_in_use(PoolAllocatorMemoryBucket* bucket, uSize first, uSize number)
+    PoolAllocatorBucketStatistics memory_bucket_get_statistics(PoolAllocatorMemoryBucket* bucket)
     {
-        auto setBit = [](u8 value, uSize bit) -> u8
+        memory_bucket_lock(bucket);
+        // Blocks in the free list are marked as used in the ledger, so largest free run doesn't include them
+        uSize largestFreeRun = 0;
+        uSize firstFreeBlockId = memory_bucket_find_free_block(bucket, 0);
+        while (firstFreeBlockId < bucket->blockCount)
         {
-            return value | (1 << bit);
+            uSize firstUsedBlockId = memory_bucket_find_used_block(bucket, firstFreeBlockId);
+            largestFreeRun = std::max(largestFreeRun, firstUsedBlockId - firstFreeBlockId);
+            firstFreeBlockId = memory_bucket_find_free_block(bucket, firstUsedBlockId);
+        }
+        PoolAllocatorBucketStatistics result
+        {
+            .blockSizeBytes         = bucket->blockSizeBytes,
+            .blockCount             = bucket->blockCount,
+            .usedBlocks             = bucket->usedBlocks,
+            .freeListBlocks         = bucket->freeListSize,
+            .largestFreeRunBlocks   = largestFreeRun,
         };
-        for (uSize it = 0; it < number; it++)
+        memory_bucket_unlock(bucket);
+        return result;
+    }
+
+    uSize memory_bucket_alignment_step(PoolAllocatorMemoryBucket* bucket, uSize alignment)
+    {
+        // Bucket memory is aligned to MAX_MEMORY_ALIGNMENT, so correctly aligned blocks are the ones
+        // with ids divisible by alignment step (alignment divided by the largest power of two of block size)
+        const uSize blockSizeAlignment = uSize(1) << count_trailing_zeros(bucket->blockSizeBytes);
+        return alignment > blockSizeAlignment ? alignment / blockSizeAlignment : 1;
+    }
+
+    uSize memory_bucket_find_contiguous_blocks(PoolAllocatorMemoryBucket* bucket, uSize number, uSize alignment)
+    {
+        const uSize alignmentStep = memory_bucket_alignment_step(bucket, alignment);
+        uSize currentBlockId = bucket->firstFreeBlockHint;
+        while (true)
         {
-            uSize currentByte = (first + it) / 8;
-            uSize currentBit = (first + it) % 8;
-            u8* byte = static_cast<u8*>(bucket->ledger) + currentByte;
-            *byte = setBit(*byte, currentBit);
+            uSize firstFreeBlockId = memory_bucket_find_free_block(bucket, currentBlockId);
+            uSize firstBlockId = (firstFreeBlockId + alignmentStep - 1) & ~(alignmentStep - 1);
+            if (firstBlockId >= bucket->blockCount || (bucket->blockCount - firstBlockId) < number)
+            {
+                // if nothing was found return blockCount - this indicates failure of method
+                return bucket->blockCount;
+            }
+            uSize firstUsedBlockId = memory_bucket_find_used_block(bucket, firstBlockId);
+            if ((firstUsedBlockId - firstBlockId) >= number)
+            {
+                return firstBlockId;
+            }
+            currentBlockId = firstUsedBlockId;
         }
     }
 
-    void memory_bucket_set_blocks_free(PoolAllocatorMemoryBucket* bucket, uSize first, uSize number)
+    void memory_bucket_set_blocks_in_use(PoolAllocatorMemoryBucket* bucket, uSize first, uSize number)
     {
-        auto removeBit = [](u8 value, uSize bit) -> u8
+        if (first == bucket->firstFreeBlockHint)
         {
-            return value & ~(1 << bit);
-        };
-        for (uSize it = 0; it < number; it++)
+            bucket->firstFreeBlockHint = first + number;
+        }
+        uSize wordId = first / 64;
+        uSize bitId = first % 64;
+        while (number)
+        {
+            const uSize numBits = std::min(number, 64 - bitId);
+            const u64 mask = (numBits == 64 ? ~u64(0) : ((u64(1) << numBits) - 1)) << bitId;
+            bucket->ledger[wordId] |= mask;
+            number -= numBits;
+            wordId += 1;
+            bitId = 0;
+        }
+    }
+
+    void memory_bucket_set_blocks_free(PoolAllocatorMemoryBucket* bucket, uSize first, uSize number)
+    {
+        bucket->firstFreeBlockHint = std::min(bucket->firstFreeBlockHint, first);
+        uSize wordId = first / 64;
+        uSize bitId = first % 64;
+        while (number)
         {
-            uSize currentByte = (first + it) / 8;
-            uSize currentBit = (first + it) % 8;
-            u8* byte = static_cast<u8*>(bucket->ledger) + currentByte;
-            *byte = removeBit(*byte, currentBit);
+            const uSize numBits = std::min(number, 64 - bitId);
+            const u64 mask = (numBits == 64 ? ~u64(0) : ((u64(1) << numBits) - 1)) << bitId;
+            bucket->ledger[wordId] &= ~mask;
+            number -= numBits;
+            wordId += 1;
+            bitId = 0;
         }
     }
 
     bool operator < (const PoolAllocatorBucketCompareInfo& one, const PoolAllocatorBucketCompareInfo& other)
     {
+        // Buckets where every block is correctly aligned go first, because other buckets have to skip blocks
+        if (one.alignmentStep != other.alignmentStep) return one.alignmentStep < other.alignmentStep;
         return (one.memoryWasted == other.memoryWasted) ? one.blocksUsed < other.blocksUsed : one.memoryWasted < other.memoryWasted;
     }
 
@@ -305,15 +756,68 @@ namespace al
     {
         allocator->bindings = *bindings;
         std::memset(&allocator->buckets, 0, sizeof(decltype(allocator->buckets)));
-        for (uSize it = 0; it < EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS; it++)
+        std::memset(&allocator->stats, 0, sizeof(AllocatorStatistics));
+        tls_construct(&allocator->threadCaches);
+        auto toPages = [](uSize sizeBytes) -> uSize { return 1 + ((sizeBytes - 1) / PoolAllocator::LOOKUP_PAGE_SIZE_BYTES); };
+        uSize numBuckets;
+        uSize numPages = 0;
+        for (numBuckets = 0; numBuckets < EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS; numBuckets++)
         {
-            const PoolAllocatorBucketDescription* desc = &bucketDescriptions[it];
+            const PoolAllocatorBucketDescription* desc = &bucketDescriptions[numBuckets];
             if (desc->blockSizeBytes == 0 || desc->blockCount == 0)
             {
                 break;
             }
-            PoolAllocatorMemoryBucket* bucket = &allocator->buckets[it];
-            memory_bucket_construct(bucket, desc->blockSizeBytes, desc->blockCount, bindings);
+            numPages += toPages(desc->blockSizeBytes * desc->blockCount);
+        }
+        allocator->memorySizeBytes = numPages * PoolAllocator::LOOKUP_PAGE_SIZE_BYTES;
+        allocator->memory = allocate(bindings, allocator->memorySizeBytes, EngineConfig::MAX_MEMORY_ALIGNMENT);
+        allocator->bucketLookup = allocate<u8>(bindings, numPages);
+        uSize currentPage = 0;
+        for (uSize it = 0; it < numBuckets; it++)
+        {
+            const PoolAllocatorBucketDescription* desc = &bucketDescriptions[it];
+            const uSize bucketPages = toPages(desc->blockSizeBytes * desc->blockCount);
+            u8* bucketMemory = static_cast<u8*>(allocator->memory) + currentPage * PoolAllocator::LOOKUP_PAGE_SIZE_BYTES;
+            memory_bucket_construct(&allocator->buckets[it], desc->blockSizeBytes, desc->blockCount, bucketMemory, bindings);
+            std::memset(allocator->bucketLookup + currentPage, int(it), bucketPages);
+            currentPage += bucketPages;
+        }
+        //
+        // Build size class table. Buckets are compared using the largest allocation size of the size class.
+        //
+        for (uSize alignmentClass = 0; alignmentClass < PoolAllocator::NUM_ALIGNMENT_CLASSES; alignmentClass++)
+        {
+            const uSize alignment = uSize(1) << alignmentClass;
+            for (uSize sizeClass = 0; sizeClass < PoolAllocator::NUM_SIZE_CLASSES; sizeClass++)
+            {
+                const uSize memorySizeBytes = uSize(1) << sizeClass;
+                PoolAllocatorBucketCompareInfo compareInfos[EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS] = {};
+                uSize numCandidates = 0;
+                for (uSize it = 0; it < numBuckets; it++)
+                {
+                    PoolAllocatorMemoryBucket* bucket = &allocator->buckets[it];
+                    const uSize blockNum = 1 + ((memorySizeBytes - 1) / bucket->blockSizeBytes);
+                    if (blockNum > bucket->blockCount)
+                    {
+                        continue;
+                    }
+                    compareInfos[numCandidates++] =
+                    {
+                        .bucketId       = it,
+                        .alignmentStep  = memory_bucket_alignment_step(bucket, alignment),
+                        .blocksUsed     = blockNum,
+                        .memoryWasted   = blockNum * bucket->blockSizeBytes - memorySizeBytes,
+                    };
+                }
+                std::sort(compareInfos, compareInfos + numCandidates);
+                PoolAllocatorSizeClass* sizeClassInfo = &allocator->sizeClasses[alignmentClass][sizeClass];
+                sizeClassInfo->numBuckets = u8(numCandidates);
+                for (uSize it = 0; it < numCandidates; it++)
+                {
+                    sizeClassInfo->bucketIds[it] = u8(compareInfos[it].bucketId);
+                }
+            }
         }
     }
 
@@ -328,68 +832,439 @@ namespace al
             }
             memory_bucket_destruct(bucket, &allocator->bindings);
         }
+        const uSize numPages = allocator->memorySizeBytes / PoolAllocator::LOOKUP_PAGE_SIZE_BYTES;
+        deallocate<u8>(&allocator->bindings, allocator->bucketLookup, numPages);
+        deallocate(&allocator->bindings, allocator->memory, allocator->memorySizeBytes);
+        tls_destroy(&allocator->threadCaches);
     }
 
     void* allocate(PoolAllocator* allocator, uSize memorySizeBytes, uSize alignment)
     {
         al_check_alignment(alignment);
-        PoolAllocatorBucketCompareInfo compareInfos[EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS] = {};
-        uSize it;
-        // @NOTE :  this bucket comparison doesn't take into account an alignment of allocation
-        for (it = 0; it < EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS; it++)
+        const uSize sizeClass = log2_ceil(memorySizeBytes);
+        const uSize alignmentClass = count_trailing_zeros(alignment);
+        PoolAllocatorSizeClass* sizeClassInfo = &allocator->sizeClasses[alignmentClass][sizeClass];
+        PoolAllocatorThreadCache* cache = nullptr;
+        for (uSize it = 0; it < sizeClassInfo->numBuckets; it++)
         {
-            PoolAllocatorMemoryBucket* bucket = &allocator->buckets[it];
-            if (!bucket->memory)
+            const uSize bucketId = sizeClassInfo->bucketIds[it];
+            PoolAllocatorMemoryBucket* bucket = &allocator->buckets[bucketId];
+            if (pool_allocator_is_cacheable(bucket, memorySizeBytes, alignment))
             {
-                break;
+                cache = cache ? cache : tls_access(&allocator->threadCaches);
+                if (cache)
+                {
+                    PoolAllocatorThreadCacheBin* bin = &cache->bins[bucketId];
+                    if (!bin->head)
+                    {
+                        memory_bucket_refill_thread_cache(bucket, bin, PoolAllocator::THREAD_CACHE_BATCH_SIZE);
+                    }
+                    if (!bin->head)
+                    {
+                        continue;
+                    }
+                    void* result = bin->head;
+                    bin->head = *static_cast<void**>(result);
+                    bin->size -= 1;
+                    al_memory_stats(allocator_statistics_on_allocate(&allocator->stats, memorySizeBytes));
+                    return result;
+                }
             }
-            PoolAllocatorBucketCompareInfo* info = &compareInfos[it];
-            info->bucketId = it;
-            if (bucket->blockSizeBytes >= memorySizeBytes)
+            void* result = memory_bucket_allocate(bucket, memorySizeBytes, alignment);
+            if (result)
             {
-                info->blocksUsed = 1;
-                info->memoryWasted = bucket->blockSizeBytes - memorySizeBytes;
+                al_memory_stats(allocator_statistics_on_allocate(&allocator->stats, memorySizeBytes));
+                return result;
             }
-            else
+        }
+        return nullptr;
+    }
+
+    void deallocate(PoolAllocator* allocator, void* ptr, uSize memorySizeBytes)
+    {
+        PoolAllocatorMemoryBucket* bucket = pool_allocator_find_bucket(allocator, ptr);
+        if (!bucket)
+        {
+            return;
+        }
+        al_memory_stats(allocator_statistics_on_deallocate(&allocator->stats, memorySizeBytes));
+        PoolAllocatorThreadCache* cache = pool_allocator_is_cacheable(bucket, memorySizeBytes, 1) ? tls_access(&allocator->threadCaches) : nullptr;
+        if (!cache)
+        {
+            memory_bucket_deallocate(bucket, ptr, memorySizeBytes);
+            return;
+        }
+        PoolAllocatorThreadCacheBin* bin = &cache->bins[bucket - allocator->buckets];
+        *static_cast<void**>(ptr) = bin->head;
+        bin->head = ptr;
+        bin->size += 1;
+        if (bin->size > PoolAllocator::THREAD_CACHE_MAX_SIZE)
+        {
+            memory_bucket_drain_thread_cache(bucket, bin, PoolAllocator::THREAD_CACHE_BATCH_SIZE);
+        }
+    }
+
+    void* reallocate(PoolAllocator* allocator, void* ptr, uSize oldMemorySizeBytes, uSize newMemorySizeBytes, uSize alignment)
+    {
+        // Allocation is resized in place by releasing trailing blocks or by taking free blocks right after it
+        al_check_alignment(alignment);
+        // Block counts below can't be computed for zero sizes : zero new size frees, zero old size allocates
+        if (newMemorySizeBytes == 0)
+        {
+            if (ptr && oldMemorySizeBytes)
             {
-                uSize blockNum = 1 + ((memorySizeBytes - 1) / bucket->blockSizeBytes);
-                uSize blockMemory = blockNum * bucket->blockSizeBytes;
-                info->blocksUsed = blockNum;
-                info->memoryWasted = blockMemory - memorySizeBytes;
+                deallocate(allocator, ptr, oldMemorySizeBytes);
             }
+            return nullptr;
+        }
+        if (!ptr || oldMemorySizeBytes == 0)
+        {
+            return allocate(allocator, newMemorySizeBytes, alignment);
+        }
+        PoolAllocatorMemoryBucket* bucket = pool_allocator_find_bucket(allocator, ptr);
+        if (!bucket || (reinterpret_cast<uPtr>(ptr) & (alignment - 1)))
+        {
+            return reallocate_by_moving(allocator, ptr, oldMemorySizeBytes, newMemorySizeBytes, alignment);
         }
-        std::sort(compareInfos, compareInfos + it);
-        void* result = nullptr;
-        for (it = 0; it < EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS; it++)
+        const uSize oldBlockNum = 1 + ((oldMemorySizeBytes - 1) / bucket->blockSizeBytes);
+        const uSize newBlockNum = 1 + ((newMemorySizeBytes - 1) / bucket->blockSizeBytes);
+        const uSize blockId = (static_cast<u8*>(ptr) - static_cast<u8*>(bucket->memory)) / bucket->blockSizeBytes;
+        bool isResized = true;
+        memory_bucket_lock(bucket);
+        if (newBlockNum < oldBlockNum)
         {
-            PoolAllocatorBucketCompareInfo* info = &compareInfos[it];
-            if (info->blocksUsed == 0)
+            memory_bucket_set_blocks_free(bucket, blockId + newBlockNum, oldBlockNum - newBlockNum);
+            al_memory_stats(bucket->usedBlocks -= oldBlockNum - newBlockNum);
+        }
+        else if (newBlockNum > oldBlockNum)
+        {
+            const uSize firstNewBlockId = blockId + oldBlockNum;
+            const uSize numNewBlocks = newBlockNum - oldBlockNum;
+            isResized = (bucket->blockCount - firstNewBlockId) >= numNewBlocks && memory_bucket_find_used_block(bucket, firstNewBlockId) >= (firstNewBlockId + numNewBlocks);
+            if (isResized)
             {
-                break;
+                memory_bucket_set_blocks_in_use(bucket, firstNewBlockId, numNewBlocks);
+                al_memory_stats(bucket->usedBlocks += numNewBlocks);
             }
-            result = memory_bucket_allocate(&allocator->buckets[info->bucketId], memorySizeBytes, alignment);
-            if (result)
+        }
+        memory_bucket_unlock(bucket);
+        if (!isResized)
+        {
+            return reallocate_by_moving(allocator, ptr, oldMemorySizeBytes, newMemorySizeBytes, alignment);
+        }
+        al_memory_stats(allocator_statistics_on_reallocate(&allocator->stats, oldMemorySizeBytes, newMemorySizeBytes));
+        return ptr;
+    }
+
+    bool pool_allocator_is_cacheable(PoolAllocatorMemoryBucket* bucket, uSize memorySizeBytes, uSize alignment)
+    {
+        // Thread caches hold single blocks linked through their first bytes, and any block of the bucket must satisfy the alignment
+        return memorySizeBytes <= bucket->blockSizeBytes && bucket->blockSizeBytes >= sizeof(void*) && memory_bucket_alignment_step(bucket, alignment) == 1;
+    }
+
+    void pool_allocator_flush_thread_caches(PoolAllocator* allocator)
+    {
+        // @NOTE :  This touches caches of all threads, so user must guarantee that no other thread uses the allocator
+        const uSize numCaches = platform_atomic_64_bit_load(&allocator->threadCaches.size, MemoryOrder::ACQUIRE);
+        for (uSize cacheIt = 0; cacheIt < numCaches; cacheIt++)
+        {
+            PoolAllocatorThreadCache* cache = &allocator->threadCaches.memory[cacheIt];
+            for (uSize bucketIt = 0; bucketIt < EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS; bucketIt++)
             {
-                break;
+                PoolAllocatorThreadCacheBin* bin = &cache->bins[bucketIt];
+                if (bin->size)
+                {
+                    memory_bucket_drain_thread_cache(&allocator->buckets[bucketIt], bin, bin->size);
+                }
+            }
+        }
+    }
+
+    PoolAllocatorMemoryBucket* pool_allocator_find_bucket(PoolAllocator* allocator, void* ptr)
+    {
+        const uPtr offset = reinterpret_cast<uPtr>(ptr) - reinterpret_cast<uPtr>(allocator->memory);
+        // If ptr is below allocator memory, offset wraps around and this check fails too
+        if (offset >= allocator->memorySizeBytes)
+        {
+            return nullptr;
+        }
+        PoolAllocatorMemoryBucket* bucket = &allocator->buckets[allocator->bucketLookup[offset / PoolAllocator::LOOKUP_PAGE_SIZE_BYTES]];
+        return memory_bucket_is_belongs(bucket, ptr) ? bucket : nullptr;
+    }
+
+    uSize tlsf_block_size(TlsfBlock* block)
+    {
+        return block->sizeAndFlags & ~TlsfAllocator::FREE_FLAG;
+    }
+
+    bool tlsf_block_is_free(TlsfBlock* block)
+    {
+        return block->sizeAndFlags & TlsfAllocator::FREE_FLAG;
+    }
+
+    TlsfBlock* tlsf_block_next_physical(TlsfBlock* block)
+    {
+        return reinterpret_cast<TlsfBlock*>(static_cast<u8*>(tlsf_block_to_ptr(block)) + tlsf_block_size(block));
+    }
+
+    void* tlsf_block_to_ptr(TlsfBlock* block)
+    {
+        return reinterpret_cast<u8*>(block) + TlsfAllocator::BLOCK_HEADER_SIZE;
+    }
+
+    TlsfBlock* tlsf_ptr_to_block(void* ptr)
+    {
+        return reinterpret_cast<TlsfBlock*>(static_cast<u8*>(ptr) - TlsfAllocator::BLOCK_HEADER_SIZE);
+    }
+
+    void tlsf_mapping(uSize size, uSize* fl, uSize* sl)
+    {
+        if (size < TlsfAllocator::SMALL_BLOCK_SIZE)
+        {
+            // Small blocks are stored in the first list, split linearly
+            *fl = 0;
+            *sl = size / (TlsfAllocator::SMALL_BLOCK_SIZE / TlsfAllocator::SL_INDEX_COUNT);
+        }
+        else
+        {
+            const uSize log2Size = 63 - count_leading_zeros(size);
+            *sl = (size >> (log2Size - TlsfAllocator::SL_INDEX_COUNT_LOG2)) ^ TlsfAllocator::SL_INDEX_COUNT;
+            *fl = log2Size - (TlsfAllocator::FL_INDEX_SHIFT - 1);
+        }
+    }
+
+    void tlsf_insert_free_block(TlsfAllocator* allocator, TlsfBlock* block)
+    {
+        uSize fl, sl;
+        tlsf_mapping(tlsf_block_size(block), &fl, &sl);
+        TlsfBlock* head = allocator->freeLists[fl][sl];
+        block->nextFree = head;
+        block->prevFree = nullptr;
+        if (head) head->prevFree = block;
+        allocator->freeLists[fl][sl] = block;
+        allocator->flBitmap |= u64(1) << fl;
+        allocator->slBitmaps[fl] |= u32(1) << sl;
+    }
+
+    void tlsf_remove_free_block(TlsfAllocator* allocator, TlsfBlock* block)
+    {
+        uSize fl, sl;
+        tlsf_mapping(tlsf_block_size(block), &fl, &sl);
+        if (block->prevFree) block->prevFree->nextFree = block->nextFree;
+        if (block->nextFree) block->nextFree->prevFree = block->prevFree;
+        if (allocator->freeLists[fl][sl] == block)
+        {
+            allocator->freeLists[fl][sl] = block->nextFree;
+            if (!block->nextFree)
+            {
+                allocator->slBitmaps[fl] &= ~(u32(1) << sl);
+                if (!allocator->slBitmaps[fl])
+                {
+                    allocator->flBitmap &= ~(u64(1) << fl);
+                }
             }
         }
+    }
+
+    TlsfBlock* tlsf_find_free_block(TlsfAllocator* allocator, uSize size)
+    {
+        // Round size up to the next list boundary, so any block in the found list is big enough
+        if (size >= TlsfAllocator::SMALL_BLOCK_SIZE)
+        {
+            size += (uSize(1) << (63 - count_leading_zeros(size) - TlsfAllocator::SL_INDEX_COUNT_LOG2)) - 1;
+        }
+        uSize fl, sl;
+        tlsf_mapping(size, &fl, &sl);
+        if (fl >= TlsfAllocator::FL_INDEX_COUNT)
+        {
+            return nullptr;
+        }
+        u32 slMap = allocator->slBitmaps[fl] & (~u32(0) << sl);
+        if (!slMap)
+        {
+            const u64 flMap = (fl + 1) < 64 ? allocator->flBitmap & (~u64(0) << (fl + 1)) : 0;
+            if (!flMap)
+            {
+                return nullptr;
+            }
+            fl = count_trailing_zeros(flMap);
+            slMap = allocator->slBitmaps[fl];
+        }
+        sl = count_trailing_zeros(slMap);
+        TlsfBlock* block = allocator->freeLists[fl][sl];
+        tlsf_remove_free_block(allocator, block);
+        return block;
+    }
+
+    TlsfBlock* tlsf_split_block(TlsfBlock* block, uSize size)
+    {
+        // Splits block into a block of given size and the remainder. Returns the remainder.
+        // Remainder has the same free flag as the original block
+        TlsfBlock* next = tlsf_block_next_physical(block);
+        TlsfBlock* remainder = reinterpret_cast<TlsfBlock*>(static_cast<u8*>(tlsf_block_to_ptr(block)) + size);
+        const uSize flags = block->sizeAndFlags & TlsfAllocator::FREE_FLAG;
+        remainder->sizeAndFlags = (tlsf_block_size(block) - size - TlsfAllocator::BLOCK_HEADER_SIZE) | flags;
+        remainder->prevPhysical = block;
+        next->prevPhysical = remainder;
+        block->sizeAndFlags = size | flags;
+        return remainder;
+    }
+
+    TlsfBlock* tlsf_merge_with_prev(TlsfAllocator* allocator, TlsfBlock* block)
+    {
+        TlsfBlock* prev = block->prevPhysical;
+        if (!prev || !tlsf_block_is_free(prev))
+        {
+            return block;
+        }
+        tlsf_remove_free_block(allocator, prev);
+        prev->sizeAndFlags += tlsf_block_size(block) + TlsfAllocator::BLOCK_HEADER_SIZE;
+        tlsf_block_next_physical(prev)->prevPhysical = prev;
+        return prev;
+    }
+
+    void tlsf_merge_with_next(TlsfAllocator* allocator, TlsfBlock* block)
+    {
+        TlsfBlock* next = tlsf_block_next_physical(block);
+        if (!tlsf_block_is_free(next))
+        {
+            return;
+        }
+        tlsf_remove_free_block(allocator, next);
+        block->sizeAndFlags += tlsf_block_size(next) + TlsfAllocator::BLOCK_HEADER_SIZE;
+        tlsf_block_next_physical(block)->prevPhysical = block;
+    }
+
+    uSize tlsf_largest_free_block(TlsfAllocator* allocator)
+    {
+        // Blocks in the highest non-empty list are bigger than blocks in any other list
+        if (!allocator->flBitmap)
+        {
+            return 0;
+        }
+        const uSize fl = 63 - count_leading_zeros(allocator->flBitmap);
+        const uSize sl = 63 - count_leading_zeros(u64(allocator->slBitmaps[fl]));
+        uSize result = 0;
+        for (TlsfBlock* block = allocator->freeLists[fl][sl]; block; block = block->nextFree)
+        {
+            result = std::max(result, tlsf_block_size(block));
+        }
         return result;
     }
 
-    void deallocate(PoolAllocator* allocator, void* ptr, uSize memorySizeBytes)
+    void construct(TlsfAllocator* allocator, uSize memorySizeBytes, AllocatorBindings* bindings)
     {
-        for (uSize it = 0; it < EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS; it++)
+        al_assert_msg(memorySizeBytes > (2 * TlsfAllocator::BLOCK_HEADER_SIZE + TlsfAllocator::MIN_BLOCK_SIZE), "Tlsf allocator memory size is too small");
+        al_assert_msg(memorySizeBytes < (u64(1) << TlsfAllocator::FL_INDEX_MAX), "Tlsf allocator memory size is too big");
+        std::memset(allocator, 0, sizeof(TlsfAllocator));
+        allocator->bindings = *bindings;
+        allocator->memorySizeBytes = memorySizeBytes & ~(EngineConfig::DEFAULT_MEMORY_ALIGNMENT - 1);
+        allocator->memory = allocate(bindings, allocator->memorySizeBytes, EngineConfig::MAX_MEMORY_ALIGNMENT);
+        //
+        // Memory consists of one big free block and a zero-sized used sentinel block at the end.
+        // Sentinel makes it possible to get next physical block of any real block without range checks.
+        //
+        TlsfBlock* block = static_cast<TlsfBlock*>(allocator->memory);
+        block->prevPhysical = nullptr;
+        block->sizeAndFlags = (allocator->memorySizeBytes - 2 * TlsfAllocator::BLOCK_HEADER_SIZE) | TlsfAllocator::FREE_FLAG;
+        TlsfBlock* sentinel = tlsf_block_next_physical(block);
+        sentinel->prevPhysical = block;
+        sentinel->sizeAndFlags = 0;
+        tlsf_insert_free_block(allocator, block);
+    }
+
+    void destruct(TlsfAllocator* allocator)
+    {
+        deallocate(&allocator->bindings, allocator->memory, allocator->memorySizeBytes);
+    }
+
+    void* allocate(TlsfAllocator* allocator, uSize memorySizeBytes, uSize alignment)
+    {
+        al_check_alignment(alignment);
+        const uSize size = align_size(std::max(memorySizeBytes, TlsfAllocator::MIN_BLOCK_SIZE));
+        // Payloads are always aligned to DEFAULT_MEMORY_ALIGNMENT. For bigger alignments we need
+        // additional space to cut an aligned part from the found block
+        const bool isOveraligned = alignment > EngineConfig::DEFAULT_MEMORY_ALIGNMENT;
+        const uSize searchSize = isOveraligned ? size + alignment + sizeof(TlsfBlock) : size;
+        TlsfBlock* block = tlsf_find_free_block(allocator, searchSize);
+        if (!block)
         {
-            PoolAllocatorMemoryBucket* bucket = &allocator->buckets[it];
-            if (!bucket->memory)
+            return nullptr;
+        }
+        if (isOveraligned)
+        {
+            u8* payload = static_cast<u8*>(tlsf_block_to_ptr(block));
+            u8* alignedPayload = align_pointer(payload, alignment);
+            if (alignedPayload != payload && uSize(alignedPayload - payload) < sizeof(TlsfBlock))
             {
-                break;
+                // Gap is too small to be a separate block
+                alignedPayload = align_pointer(payload + sizeof(TlsfBlock), alignment);
             }
-            if (memory_bucket_is_belongs(bucket, ptr))
+            if (alignedPayload != payload)
             {
-                memory_bucket_deallocate(bucket, ptr, memorySizeBytes);
-                break;
+                // Leading part becomes a free block. It can't have free neighbours, because
+                // original block was free and adjacent free blocks are always merged
+                TlsfBlock* leading = block;
+                block = tlsf_split_block(leading, uSize(alignedPayload - payload) - TlsfAllocator::BLOCK_HEADER_SIZE);
+                tlsf_insert_free_block(allocator, leading);
             }
         }
+        if (tlsf_block_size(block) >= (size + sizeof(TlsfBlock)))
+        {
+            TlsfBlock* remainder = tlsf_split_block(block, size);
+            tlsf_merge_with_next(allocator, remainder);
+            tlsf_insert_free_block(allocator, remainder);
+        }
+        block->sizeAndFlags &= ~TlsfAllocator::FREE_FLAG;
+        al_memory_stats(allocator_statistics_on_allocate(&allocator->stats, tlsf_block_size(block)));
+        return tlsf_block_to_ptr(block);
+    }
+
+    void deallocate(TlsfAllocator* allocator, void* ptr, uSize memorySizeBytes)
+    {
+        if (!ptr)
+        {
+            return;
+        }
+        TlsfBlock* block = tlsf_ptr_to_block(ptr);
+        al_assert_msg(!tlsf_block_is_free(block), "Double free in tlsf allocator");
+        al_memory_stats(allocator_statistics_on_deallocate(&allocator->stats, tlsf_block_size(block)));
+        block->sizeAndFlags |= TlsfAllocator::FREE_FLAG;
+        block = tlsf_merge_with_prev(allocator, block);
+        tlsf_merge_with_next(allocator, block);
+        tlsf_insert_free_block(allocator, block);
+    }
+
+    void* reallocate(TlsfAllocator* allocator, void* ptr, uSize oldMemorySizeBytes, uSize newMemorySizeBytes, uSize alignment)
+    {
+        // Block is resized in place if it (together with the next physical block, if that one is free) is big enough
+        al_check_alignment(alignment);
+        if (!ptr || (reinterpret_cast<uPtr>(ptr) & (alignment - 1)))
+        {
+            return reallocate_by_moving(allocator, ptr, oldMemorySizeBytes, newMemorySizeBytes, alignment);
+        }
+        TlsfBlock* block = tlsf_ptr_to_block(ptr);
+        al_assert_msg(!tlsf_block_is_free(block), "Reallocating free block in tlsf allocator");
+        const uSize size = align_size(std::max(newMemorySizeBytes, TlsfAllocator::MIN_BLOCK_SIZE));
+        const uSize oldBlockSize = tlsf_block_size(block);
+        TlsfBlock* next = tlsf_block_next_physical(block);
+        const uSize availableSize = oldBlockSize + (tlsf_block_is_free(next) ? tlsf_block_size(next) + TlsfAllocator::BLOCK_HEADER_SIZE : 0);
+        if (availableSize < size)
+        {
+            return reallocate_by_moving(allocator, ptr, oldMemorySizeBytes, newMemorySizeBytes, alignment);
+        }
+        if (oldBlockSize < size)
+        {
+            tlsf_merge_with_next(allocator, block);
+        }
+        if (tlsf_block_size(block) >= (size + sizeof(TlsfBlock)))
+        {
+            TlsfBlock* remainder = tlsf_split_block(block, size);
+            remainder->sizeAndFlags |= TlsfAllocator::FREE_FLAG;
+            tlsf_merge_with_next(allocator, remainder);
+            tlsf_insert_free_block(allocator, remainder);
+        }
+        al_memory_stats(allocator_statistics_on_reallocate(&allocator->stats, oldBlockSize, tlsf_block_size(block)));
+        return ptr;
     }
 }
@@ -2,41 +2,116 @@
 #define AL_MEMORY_H
 
 #include <cstdlib>
+#include <cstddef>
 
 #include "allocator_bindings.h"
 #include "engine/types.h"
 #include "engine/config.h"
 #include "engine/debug/assert.h"
+#include "engine/platform/platform_atomics.h"
+#include "engine/platform/platform_memory.h"
+#include "engine/platform/platform_threads.h"
+#include "engine/utilities/thread_local_storage.h"
+#include "engine/utilities/spin_lock.h"
 
 #define al_align                        alignas(EngineConfig::DEFAULT_MEMORY_ALIGNMENT)
 #define al_check_alignment(alignment)   al_assert_msg(((alignment - 1) & alignment) == 0, "Alignment must be a power of two"); \
                                         al_assert_msg(alignment <= EngineConfig::MAX_MEMORY_ALIGNMENT, "Requested alignment is too big - consider updating EngineConfig::MAX_MEMORY_ALIGNMENT value")
 
+#ifdef AL_MEMORY_STATISTICS_ENABLED
+#   define al_memory_stats(cmd) cmd
+#else
+#   define al_memory_stats(cmd)
+#endif
+
 #ifdef _MSC_VER
 #   define al_aligned_system_malloc(size, alignment) _aligned_malloc(size, alignment)
 #   define al_aligned_system_free(ptr) _aligned_free(ptr)
 #else
-#   define al_aligned_system_malloc(size, alignment) std::aligned_alloc(size, alignment)
+#   define al_aligned_system_malloc(size, alignment) std::aligned_alloc(alignment, size)
 #   define al_aligned_system_free(ptr) std::free(ptr)
 #endif
 
 namespace al
 {
+    // ===============================================================================================
+    // Memory statistics data
+    // ===============================================================================================
+
+    // @NOTE :  Statistics are gathered only if AL_MEMORY_STATISTICS_ENABLED is defined.
+    //          All counters are atomic, so statistics can be updated from any thread.
+    struct AllocatorStatistics
+    {
+        Atomic<u64> liveBytes;
+        Atomic<u64> peakBytes;
+        Atomic<u64> numAllocations;
+        Atomic<u64> numDeallocations;
+    };
+
+    struct PoolAllocatorBucketStatistics
+    {
+        uSize blockSizeBytes;
+        uSize blockCount;
+        uSize usedBlocks;
+        uSize freeListBlocks;
+        uSize largestFreeRunBlocks;
+    };
+
+    // @NOTE :  Wrapper around any allocator bindings which gathers statistics under a caller-supplied tag
+    struct TaggedAllocator
+    {
+        AllocatorBindings bindings;
+        const char* tag;
+        AllocatorStatistics stats;
+    };
+
     // ===============================================================================================
     // Stack allocator data
     // ===============================================================================================
 
+    // @NOTE :  Stack allocator is lock-free - any number of threads can allocate from the same
+    //          stack simultaneously. Top pointer is moved with compare-and-swap operation.
+    //          stack_alloactor_reset can be called from any thread, but user must guarantee
+    //          that no memory allocated before reset is used after it and that no other thread
+    //          allocates from the stack while reset is running.
+    //
+    // @NOTE :  Stack allocator constructed with construct_virtual only reserves address space and
+    //          commits pages on demand as top grows. On reset, pages commited beyond
+    //          highWaterMarkBytes are returned to the system.
+    //
+    // @NOTE :  Deallocation of the most recent allocation moves top back, so strictly LIFO scratch
+    //          memory (for example arrays destroyed with defer) is released immediately. For nested
+    //          temporary work markers can be used to roll back everything allocated after the marker.
+    //          Each allocation is preceded by a small header with the size of its alignment padding,
+    //          so top can be moved back to where it was before the allocation.
     struct StackAllocator
     {
+        using Header = u32;
         AllocatorBindings bindings;
         void* memory;
         void* memoryLimit;
-        // @TODO :  add platform atomic operations
-#if 0
-        std::atomic<void*> top;
-#else
-        void* top;
-#endif
+        Atomic<void*> top;
+        Atomic<void*> commitLimit;
+        uSize highWaterMarkBytes;
+        uSize pageSizeBytes;
+        bool isVirtual;
+        AllocatorStatistics stats;
+    };
+
+    using StackAllocatorMarker = void*;
+
+    // @NOTE :  Saves stack top on construction and rolls the stack back to it on destruction.
+    //          User must guarantee that no other thread allocates from the stack while scope is alive,
+    //          otherwise memory allocated by that thread will be released as well.
+    class StackAllocatorScope
+    {
+    public:
+        StackAllocatorScope(StackAllocator* stack);
+        ~StackAllocatorScope();
+
+    private:
+        StackAllocator* stack;
+        StackAllocatorMarker marker;
     };
 
     template<uSize SizeBytes>
@@ -50,18 +125,27 @@ namespace al
     // Pool allocator data
     // ===============================================================================================
 
+    // @NOTE :  Bucket is guarded by a spin lock. Bucket functions which change bucket state
+    //          (memory_bucket_allocate, memory_bucket_deallocate, thread cache refill and drain)
+    //          take the lock themselves.
     struct PoolAllocatorMemoryBucket
     {
-        // @TODO :  add platform mutexes
-#if 0
-        std::mutex memoryMutex;
-#endif
+        SpinLock lock;
         uSize blockSizeBytes;
         uSize blockCount;
         uSize memorySizeBytes;
-        uSize ledgerSizeBytes;
+        uSize ledgerSizeWords;
         void* memory;
-        void* ledger;
+        // @NOTE :  Each bit of the ledger represents one block. Bit is set if block is in use.
+        //          Bits past blockCount in the last word are always set, so scans never go out of range.
+        u64* ledger;
+        uSize firstFreeBlockHint; // all blocks before it are in use, so ledger scans start here
+        // @NOTE :  Intrusive list of freed single blocks (each free block stores a pointer to the next one).
+        //          Blocks in this list are still marked as used in the ledger. The list is returned
+        //          to the ledger when a multi-block allocation can't find enough contiguous space.
+        void* freeListHead;
+        uSize freeListSize;
+        uSize usedBlocks; // updated only if AL_MEMORY_STATISTICS_ENABLED is defined, includes blocks held by thread caches
     };
 
     struct PoolAllocatorBucketDescription
@@ -73,16 +157,103 @@ namespace al
     struct PoolAllocatorBucketCompareInfo
     {
         uSize bucketId;
+        uSize alignmentStep;
         uSize blocksUsed;
         uSize memoryWasted;
     };
 
     bool operator < (const PoolAllocatorBucketCompareInfo& one, const PoolAllocatorBucketCompareInfo& other);
 
+    // @NOTE :  Ordered list of buckets which should be tried for allocations of a given size class and alignment.
+    //          Size class N covers allocations with sizes in range (2^(N-1), 2^N].
+    struct PoolAllocatorSizeClass
+    {
+        u8 bucketIds[EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS];
+        u8 numBuckets;
+    };
+
+    // @NOTE :  Per-thread cache of free single blocks, one intrusive list for each bucket.
+    //          Only the owning thread touches the cache, so no synchronization is needed.
+    struct PoolAllocatorThreadCacheBin
+    {
+        void* head;
+        uSize size;
+    };
+
+    struct PoolAllocatorThreadCache
+    {
+        PoolAllocatorThreadCacheBin bins[EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS];
+    };
+
+    // @NOTE :  Memory of all buckets is allocated as a single region. Each bucket occupies a whole number
+    //          of lookup pages, so the owner of any pointer is found with a single table access.
+    //
+    // @NOTE :  Single block allocations are served from per-thread caches (in the style of tcmalloc).
+    //          Empty cache takes THREAD_CACHE_BATCH_SIZE blocks from the bucket under a single lock,
+    //          and cache which grows past THREAD_CACHE_MAX_SIZE returns a batch back to the bucket.
+    //          Multi-block allocations, and all allocations of threads which didn't get a cache
+    //          (see EngineConfig::POOL_ALLOCATOR_MAX_THREAD_CACHES), go directly to the locked buckets.
+    //          Blocks cached by a thread which has exited stay in its cache until
+    //          pool_allocator_flush_thread_caches is called. Owner of the allocator is responsible for calling it
+    //          once threads which used the allocator have exited (application does it after the job system is destroyed).
     struct PoolAllocator
     {
+        static constexpr uSize LOOKUP_PAGE_SIZE_BYTES = 64 * 1024;
+        static constexpr uSize NUM_SIZE_CLASSES = 64;
+        static constexpr uSize NUM_ALIGNMENT_CLASSES = 11; // log2(EngineConfig::MAX_MEMORY_ALIGNMENT) + 1
+        static constexpr uSize THREAD_CACHE_BATCH_SIZE = 32;
+        static constexpr uSize THREAD_CACHE_MAX_SIZE = THREAD_CACHE_BATCH_SIZE * 2;
+        static_assert((uSize(1) << (NUM_ALIGNMENT_CLASSES - 1)) == EngineConfig::MAX_MEMORY_ALIGNMENT);
+
         AllocatorBindings bindings;
         PoolAllocatorMemoryBucket buckets[EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS];
+        PoolAllocatorSizeClass sizeClasses[NUM_ALIGNMENT_CLASSES][NUM_SIZE_CLASSES];
+        void* memory;
+        uSize memorySizeBytes;
+        u8* bucketLookup; // bucket id for each lookup page of memory
+        ThreadLocalStorage<PoolAllocatorThreadCache, EngineConfig::POOL_ALLOCATOR_MAX_THREAD_CACHES> threadCaches;
+        AllocatorStatistics stats;
+    };
+
+    // ===============================================================================================
+    // TLSF allocator data
+    // ===============================================================================================
+
+    // @NOTE :  Two-Level Segregated Fit allocator (http://www.gii.upv.es/tlsf/).
+    //          Free blocks are kept in segregated lists indexed by first level (power of two) and
+    //          second level (linear subdivision of the power of two) size classes. Both levels have
+    //          bitmaps, so suitable free list is found in O(1). Adjacent free blocks are always merged.
+
+    struct TlsfBlock
+    {
+        TlsfBlock* prevPhysical;    // nullptr for the first block in memory
+        uSize sizeAndFlags;         // payload size, lowest bit is set if block is free
+        // These fields are valid only if block is free. Otherwise they are part of the payload
+        TlsfBlock* nextFree;
+        TlsfBlock* prevFree;
+    };
+
+    struct TlsfAllocator
+    {
+        static constexpr uSize ALIGNMENT_LOG2       = 3;
+        static constexpr uSize SL_INDEX_COUNT_LOG2  = 5;
+        static constexpr uSize SL_INDEX_COUNT       = uSize(1) << SL_INDEX_COUNT_LOG2;
+        static constexpr uSize FL_INDEX_SHIFT       = SL_INDEX_COUNT_LOG2 + ALIGNMENT_LOG2;
+        static constexpr uSize FL_INDEX_MAX         = 38; // blocks up to 256 GB
+        static constexpr uSize FL_INDEX_COUNT       = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+        static constexpr uSize SMALL_BLOCK_SIZE     = uSize(1) << FL_INDEX_SHIFT;
+        static constexpr uSize BLOCK_HEADER_SIZE    = offsetof(TlsfBlock, nextFree);
+        static constexpr uSize MIN_BLOCK_SIZE       = sizeof(TlsfBlock) - BLOCK_HEADER_SIZE;
+        static constexpr uSize FREE_FLAG            = 1;
+        static_assert(EngineConfig::DEFAULT_MEMORY_ALIGNMENT == (uSize(1) << ALIGNMENT_LOG2));
+
+        AllocatorBindings bindings;
+        void* memory;
+        uSize memorySizeBytes;
+        u64 flBitmap;
+        u32 slBitmaps[FL_INDEX_COUNT];
+        TlsfBlock* freeLists[FL_INDEX_COUNT][SL_INDEX_COUNT];
+        AllocatorStatistics stats;
     };
 
     // ===============================================================================================
@@ -90,24 +261,45 @@ namespace al
     // ===============================================================================================
 
     template<typename T> T* align_pointer(T* ptr, uSize alignment = EngineConfig::DEFAULT_MEMORY_ALIGNMENT);
+    constexpr uSize align_size(uSize size, uSize alignment = EngineConfig::DEFAULT_MEMORY_ALIGNMENT);
     AllocatorBindings get_system_allocator_bindings();
 
     template<typename T = void> T*      allocate    (AllocatorBindings* bindings, uSize amount = 1, uSize alignment = EngineConfig::DEFAULT_MEMORY_ALIGNMENT);
     template<typename T = void> void    deallocate  (AllocatorBindings* bindings, T* ptr, uSize amount = 1);
+    template<typename T = void> T*      reallocate  (AllocatorBindings* bindings, T* ptr, uSize oldAmount, uSize newAmount, uSize alignment = EngineConfig::DEFAULT_MEMORY_ALIGNMENT);
 
     template<typename Allocator>
     AllocatorBindings get_allocator_bindings(Allocator* allocator);
 
+    // ===============================================================================================
+    // Memory statistics interface
+    // ===============================================================================================
+
+    void    allocator_statistics_on_allocate    (AllocatorStatistics* stats, uSize memorySizeBytes);
+    void    allocator_statistics_on_deallocate  (AllocatorStatistics* stats, uSize memorySizeBytes);
+    void    allocator_statistics_on_reallocate  (AllocatorStatistics* stats, uSize oldMemorySizeBytes, uSize newMemorySizeBytes);
+    void    allocator_statistics_reset_live     (AllocatorStatistics* stats);
+
+    void    construct   (TaggedAllocator* allocator, AllocatorBindings* bindings, const char* tag);
+    void*   allocate    (TaggedAllocator* allocator, uSize memorySizeBytes, uSize alignment);
+    void    deallocate  (TaggedAllocator* allocator, void* ptr, uSize memorySizeBytes);
+    void*   reallocate  (TaggedAllocator* allocator, void* ptr, uSize oldMemorySizeBytes, uSize newMemorySizeBytes, uSize alignment);
+
     // ===============================================================================================
     // Stack allocator interface
     // ===============================================================================================
 
     void stack_alloactor_reset(StackAllocator* stack);
+    bool stack_allocator_commit(StackAllocator* stack, u8* to);
+    StackAllocatorMarker stack_allocator_get_marker(StackAllocator* stack);
+    void stack_allocator_restore_marker(StackAllocator* stack, StackAllocatorMarker marker);
 
     void    construct   (StackAllocator* stack, uSize memorySizeBytes, AllocatorBindings* bindings);
+    void    construct_virtual(StackAllocator* stack, uSize reserveSizeBytes, uSize highWaterMarkBytes);
     void    destruct    (StackAllocator* stack);
     void*   allocate    (StackAllocator* stack, uSize memorySizeBytes, uSize alignment);
     void    deallocate  (StackAllocator* stack, void* ptr, uSize memorySizeBytes);
+    void*   reallocate  (StackAllocator* stack, void* ptr, uSize oldMemorySizeBytes, uSize newMemorySizeBytes, uSize alignment);
     template<uSize SizeBytes> void*   allocate    (InplaceStackAllocator<SizeBytes>* stack, uSize memorySizeBytes, uSize alignment);
     template<uSize SizeBytes> void    deallocate  (InplaceStackAllocator<SizeBytes>* stack, void* ptr, uSize memorySizeBytes);
 
@@ -117,19 +309,56 @@ namespace al
 
     constexpr PoolAllocatorBucketDescription memory_bucket_desc(uSize blockSizeBytes, uSize memorySizeBytes);
 
-    void    memory_bucket_construct             (PoolAllocatorMemoryBucket* bucket, uSize blockSizeBytes, uSize blockCount, AllocatorBindings* bindings);
+    void    memory_bucket_construct             (PoolAllocatorMemoryBucket* bucket, uSize blockSizeBytes, uSize blockCount, void* memory, AllocatorBindings* bindings);
     void    memory_bucket_destruct              (PoolAllocatorMemoryBucket* bucket, AllocatorBindings* bindings);
     void*   memory_bucket_allocate              (PoolAllocatorMemoryBucket* bucket, uSize memorySizeBytes, uSize alignment);
     void    memory_bucket_deallocate            (PoolAllocatorMemoryBucket* bucket, void* ptr, uSize memorySizeBytes);
     bool    memory_bucket_is_belongs            (PoolAllocatorMemoryBucket* bucket, void* ptr);
+    void    memory_bucket_flush_free_list       (PoolAllocatorMemoryBucket* bucket);
+    uSize   memory_bucket_alignment_step        (PoolAllocatorMemoryBucket* bucket, uSize alignment);
     uSize   memory_bucket_find_contiguous_blocks(PoolAllocatorMemoryBucket* bucket, uSize number, uSize alignment);
+    uSize   memory_bucket_find_free_block       (PoolAllocatorMemoryBucket* bucket, uSize from);
+    uSize   memory_bucket_find_used_block       (PoolAllocatorMemoryBucket* bucket, uSize from);
+    PoolAllocatorBucketStatistics memory_bucket_get_statistics(PoolAllocatorMemoryBucket* bucket);
     void    memory_bucket_set_blocks_in_use     (PoolAllocatorMemoryBucket* bucket, uSize first, uSize number);
     void    memory_bucket_set_blocks_free       (PoolAllocatorMemoryBucket* bucket, uSize first, uSize number);
+    void    memory_bucket_lock                  (PoolAllocatorMemoryBucket* bucket);
+    void    memory_bucket_unlock                (PoolAllocatorMemoryBucket* bucket);
+    void    memory_bucket_refill_thread_cache   (PoolAllocatorMemoryBucket* bucket, PoolAllocatorThreadCacheBin* bin, uSize number);
+    void    memory_bucket_drain_thread_cache    (PoolAllocatorMemoryBucket* bucket, PoolAllocatorThreadCacheBin* bin, uSize number);
 
     void    construct   (PoolAllocator* allocator, const PoolAllocatorBucketDescription bucketDescriptions[EngineConfig::POOL_ALLOCATOR_MAX_BUCKETS], AllocatorBindings* bindings);
     void    destruct    (PoolAllocator* allocator);
     void*   allocate    (PoolAllocator* allocator, uSize memorySizeBytes, uSize alignment);
     void    deallocate  (PoolAllocator* allocator, void* ptr, uSize memorySizeBytes);
+    void*   reallocate  (PoolAllocator* allocator, void* ptr, uSize oldMemorySizeBytes, uSize newMemorySizeBytes, uSize alignment);
+    PoolAllocatorMemoryBucket* pool_allocator_find_bucket(PoolAllocator* allocator, void* ptr);
+    bool    pool_allocator_is_cacheable     (PoolAllocatorMemoryBucket* bucket, uSize memorySizeBytes, uSize alignment);
+    void    pool_allocator_flush_thread_caches(PoolAllocator* allocator);
+
+    // ===============================================================================================
+    // TLSF allocator interface
+    // ===============================================================================================
+
+    uSize       tlsf_block_size             (TlsfBlock* block);
+    bool        tlsf_block_is_free          (TlsfBlock* block);
+    TlsfBlock*  tlsf_block_next_physical    (TlsfBlock* block);
+    void*       tlsf_block_to_ptr           (TlsfBlock* block);
+    TlsfBlock*  tlsf_ptr_to_block           (void* ptr);
+    void        tlsf_mapping                (uSize size, uSize* fl, uSize* sl);
+    void        tlsf_insert_free_block      (TlsfAllocator* allocator, TlsfBlock* block);
+    void        tlsf_remove_free_block      (TlsfAllocator* allocator, TlsfBlock* block);
+    TlsfBlock*  tlsf_find_free_block        (TlsfAllocator* allocator, uSize size);
+    TlsfBlock*  tlsf_split_block            (TlsfBlock* block, uSize size);
+    TlsfBlock*  tlsf_merge_with_prev        (TlsfAllocator* allocator, TlsfBlock* block);
+    void        tlsf_merge_with_next        (TlsfAllocator* allocator, TlsfBlock* block);
+    uSize       tlsf_largest_free_block     (TlsfAllocator* allocator);
+
+    void    construct   (TlsfAllocator* allocator, uSize memorySizeBytes, AllocatorBindings* bindings);
+    void    destruct    (TlsfAllocator* allocator);
+    void*   allocate    (TlsfAllocator* allocator, uSize memorySizeBytes, uSize alignment);
+    void    deallocate  (TlsfAllocator* allocator, void* ptr, uSize memorySizeBytes);
+    void*   reallocate  (TlsfAllocator* allocator, void* ptr, uSize oldMemorySizeBytes, uSize newMemorySizeBytes, uSize alignment);
 }
 
 #endif
@@ -0,0 +1,80 @@
+
+#include "../platform_atomics.h"
+#include "platform_linux_backend.h"
+
+namespace al
+{
+    constexpr int platform_atomic_to_gcc_memory_order(MemoryOrder memoryOrder)
+    {
+        switch (memoryOrder)
+        {
+            case MemoryOrder::RELAXED:          return __ATOMIC_RELAXED;
+            case MemoryOrder::CONSUME:          return __ATOMIC_CONSUME;
+            case MemoryOrder::ACQUIRE:          return __ATOMIC_ACQUIRE;
+            case MemoryOrder::RELEASE:          return __ATOMIC_RELEASE;
+            case MemoryOrder::ACQUIRE_RELEASE:  return __ATOMIC_ACQ_REL;
+            default:                            return __ATOMIC_SEQ_CST;
+        }
+    }
+
+    template<typename T>
+    Result<T> platform_atomic_64_bit_increment(Atomic<T>* atomic)
+    {
+        dbg (if (!atomic) return err<T>("Value was a nullptr."));
+        return ok<T>(__atomic_add_fetch((volatile s64*)&atomic->value, s64(1), __ATOMIC_SEQ_CST));
+    }
+
+    template<typename T>
+    Result<T> platform_atomic_64_bit_decrement(Atomic<T>* atomic)
+    {
+        dbg (if (!atomic) return err<T>("Value was a nullptr."));
+        return ok<T>(__atomic_sub_fetch((volatile s64*)&atomic->value, s64(1), __ATOMIC_SEQ_CST));
+    }
+
+    template<typename T>
+    Result<T> platform_atomic_64_bit_add(Atomic<T>* atomic, T other)
+    {
+        dbg (if (!atomic) return err<T>("Value was a nullptr."));
+        return ok<T>(__atomic_add_fetch((volatile s64*)&atomic->value, s64(other), __ATOMIC_SEQ_CST));
+    }
+
+    template<typename T>
+    Result<T> platform_atomic_64_bit_load(Atomic<T>* atomic, MemoryOrder memoryOrder)
+    {
+        dbg (if (!atomic) return err<T>("Value was a nullptr."));
+        dbg 
+        (
+            if (memoryOrder != MemoryOrder::RELAXED && 
+                memoryOrder != MemoryOrder::CONSUME && 
+                memoryOrder != MemoryOrder::ACQUIRE && 
+                memoryOrder != MemoryOrder::SEQUENTIALLY_CONSISTENT) 
+                return err<T>("Incorrect memory order. Expected values : RELAXED, CONSUME, ACQUIRE or SEQUENTIALLY_CONSISTENT.")
+        );
+        T loaded;
+        __atomic_load((T*)&atomic->value, &loaded, platform_atomic_to_gcc_memory_order(memoryOrder));
+        return ok<T>(loaded);
+    }
+
+    template<typename T>
+    Result<T> platform_atomic_64_bit_store(Atomic<T>* atomic, T newValue, MemoryOrder memoryOrder)
+    {
+        dbg (if (!atomic) return err<T>("Value was a nullptr."));
+        dbg 
+        (
+            if (memoryOrder != MemoryOrder::RELAXED && 
+                memoryOrder != MemoryOrder::RELEASE && 
+                memoryOrder != MemoryOrder::SEQUENTIALLY_CONSISTENT) 
+                return err<T>("Incorrect memory order. Expected values : RELAXED, RELEASE or SEQUENTIALLY_CONSISTENT.")
+        );
+        __atomic_store((T*)&atomic->value, &newValue, platform_atomic_to_gcc_memory_order(memoryOrder));
+        return ok<T>(newValue);
+    }
+
+    template<typename T>
+    Result<bool> platform_atomic_64_bit_cas(Atomic<T>* atomic, T* expected, T newValue, MemoryOrder memoryOrder)
+    {
+        dbg (if (!atomic) return err<bool>("Value was a nullptr."));
+        // Same as in the Win32 backend, compare-exchange is always a full barrier
+        return ok<bool>(__atomic_compare_exchange((T*)&atomic->value, expected, &newValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+    }
+}
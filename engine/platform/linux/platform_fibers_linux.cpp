@@ -0,0 +1,74 @@
+
+#include "platform_fibers_linux.h"
+#include "../platform_memory.h"
+
+namespace al
+{
+    // makecontext passes only int arguments, so fiber pointer is split into two halves
+    void platform_fiber_entry(u32 fiberLow, u32 fiberHigh)
+    {
+        PlatformFiber* fiber = reinterpret_cast<PlatformFiber*>((uSize(fiberHigh) << 32) | uSize(fiberLow));
+        fiber->function(fiber->userData);
+    }
+
+    bool platform_fiber_convert_current_thread(PlatformFiber* fiber)
+    {
+        // Context of the thread is saved by the first switch from it
+        fiber->stack = nullptr;
+        fiber->stackSizeBytes = 0;
+        fiber->function = nullptr;
+        fiber->userData = nullptr;
+        return true;
+    }
+
+    void platform_fiber_convert_back_to_thread(PlatformFiber* fiber)
+    {
+
+    }
+
+    bool platform_fiber_create(PlatformFiber* fiber, uSize stackSizeBytes, PlatformFiberFunction function, void* userData)
+    {
+        //
+        // Stack is reserved with one extra page at the bottom, which is never commited.
+        // Stack overflow hits this guard page and crashes instead of corrupting neighbouring memory.
+        //
+        const uSize pageSize = platform_memory_get_page_size();
+        stackSizeBytes = ((stackSizeBytes + pageSize - 1) / pageSize) * pageSize;
+        u8* memory = static_cast<u8*>(platform_memory_reserve(stackSizeBytes + pageSize));
+        if (!memory)
+        {
+            return false;
+        }
+        if (!platform_memory_commit(memory + pageSize, stackSizeBytes))
+        {
+            platform_memory_release(memory, stackSizeBytes + pageSize);
+            return false;
+        }
+        fiber->stack = memory;
+        fiber->stackSizeBytes = stackSizeBytes + pageSize;
+        fiber->function = function;
+        fiber->userData = userData;
+        ::getcontext(&fiber->context);
+        fiber->context.uc_stack.ss_sp = memory + pageSize;
+        fiber->context.uc_stack.ss_size = stackSizeBytes;
+        fiber->context.uc_link = nullptr;
+        const uSize fiberAddress = reinterpret_cast<uSize>(fiber);
+        ::makecontext(&fiber->context, reinterpret_cast<void (*)()>(platform_fiber_entry), 2, u32(fiberAddress), u32(fiberAddress >> 32));
+        return true;
+    }
+
+    void platform_fiber_destroy(PlatformFiber* fiber)
+    {
+        if (fiber->stack)
+        {
+            platform_memory_release(fiber->stack, fiber->stackSizeBytes);
+            fiber->stack = nullptr;
+        }
+    }
+
+    void platform_fiber_switch(PlatformFiber* from, PlatformFiber* to)
+    {
+        // @NOTE : swapcontext also saves and restores signal mask, which costs a syscall per switch
+        ::swapcontext(&from->context, &to->context);
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef AL_PLATFORM_FIBERS_LINUX_H
+#define AL_PLATFORM_FIBERS_LINUX_H
+
+#include "platform_linux_backend.h"
+#include "../platform_fibers.h"
+
+namespace al
+{
+    struct PlatformFiber
+    {
+        ucontext_t context;
+        void* stack;            // nullptr for fibers converted from threads
+        uSize stackSizeBytes;
+        PlatformFiberFunction function;
+        void* userData;
+    };
+}
+
+#endif
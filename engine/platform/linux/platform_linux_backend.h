@@ -0,0 +1,15 @@
+#ifndef AL_PLATFORM_LINUX_BACKEND_H
+#define AL_PLATFORM_LINUX_BACKEND_H
+
+#ifndef _GNU_SOURCE
+#   define _GNU_SOURCE
+#endif
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#endif
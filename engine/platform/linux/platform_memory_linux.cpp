@@ -0,0 +1,35 @@
+
+#include "platform_memory_linux.h"
+
+namespace al
+{
+    uSize platform_memory_get_page_size()
+    {
+        return uSize(::sysconf(_SC_PAGESIZE));
+    }
+
+    void* platform_memory_reserve(uSize sizeBytes)
+    {
+        // Reserved pages are inaccessible and don't count towards the commit charge
+        void* memory = ::mmap(nullptr, sizeBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        return memory == MAP_FAILED ? nullptr : memory;
+    }
+
+    bool platform_memory_commit(void* ptr, uSize sizeBytes)
+    {
+        // Physical pages are provided by the kernel on first access
+        return ::mprotect(ptr, sizeBytes, PROT_READ | PROT_WRITE) == 0;
+    }
+
+    void platform_memory_decommit(void* ptr, uSize sizeBytes)
+    {
+        // Physical pages are returned to the system, next access after commit reads zeroes
+        ::madvise(ptr, sizeBytes, MADV_DONTNEED);
+        ::mprotect(ptr, sizeBytes, PROT_NONE);
+    }
+
+    void platform_memory_release(void* ptr, uSize sizeBytes)
+    {
+        ::munmap(ptr, sizeBytes);
+    }
+}
@@ -0,0 +1,12 @@
+#ifndef AL_PLATFORM_MEMORY_LINUX_H
+#define AL_PLATFORM_MEMORY_LINUX_H
+
+#include "platform_linux_backend.h"
+#include "../platform_memory.h"
+
+namespace al
+{
+
+}
+
+#endif
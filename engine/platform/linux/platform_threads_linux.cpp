@@ -0,0 +1,274 @@
+
+#include <cstring>
+
+#include "platform_threads_linux.h"
+
+namespace al
+{
+    //
+    // Futex
+    //
+
+    void platform_futex_wait(u32* address, u32 expectedValue)
+    {
+        // Returns immediately if value at address is not equal to the expected one. Spurious wakeups are possible.
+        ::syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expectedValue, nullptr, nullptr, 0);
+    }
+
+    void platform_futex_wake(u32* address, u32 numThreads)
+    {
+        ::syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, numThreads > 0x7FFFFFFF ? 0x7FFFFFFF : numThreads, nullptr, nullptr, 0);
+    }
+
+    //
+    // Threads
+    //
+
+    PlatformThreadId platform_get_current_thread_id()
+    {
+        // pthread_self doesn't enter the kernel, unlike gettid
+        return PlatformThreadId(::pthread_self());
+    }
+
+    void platform_thread_yield()
+    {
+        ::sched_yield();
+    }
+
+    void* platform_thread_entry(void* parameter)
+    {
+        PlatformThread* thread = static_cast<PlatformThread*>(parameter);
+        thread->function(thread->userData);
+        return nullptr;
+    }
+
+    bool platform_thread_create(PlatformThread* thread, PlatformThreadFunction function, void* userData)
+    {
+        thread->function = function;
+        thread->userData = userData;
+        return ::pthread_create(&thread->handle, nullptr, platform_thread_entry, thread) == 0;
+    }
+
+    void platform_thread_join(PlatformThread* thread)
+    {
+        ::pthread_join(thread->handle, nullptr);
+    }
+
+    bool platform_thread_set_affinity(PlatformThread* thread, uSize coreIndex)
+    {
+        const uSize core = coreIndex % platform_get_logical_core_count();
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(core, &cpuSet);
+        return ::pthread_setaffinity_np(thread->handle, sizeof(cpu_set_t), &cpuSet) == 0;
+    }
+
+    void platform_thread_set_name(PlatformThread* thread, const char* name)
+    {
+        // Linux thread names are limited to 16 bytes including the null terminator
+        char truncatedName[16];
+        std::strncpy(truncatedName, name, sizeof(truncatedName) - 1);
+        truncatedName[sizeof(truncatedName) - 1] = '\0';
+        ::pthread_setname_np(thread->handle, truncatedName);
+    }
+
+    uSize platform_get_logical_core_count()
+    {
+        const long numCores = ::sysconf(_SC_NPROCESSORS_ONLN);
+        return numCores > 0 ? uSize(numCores) : 1;
+    }
+
+    void platform_cpu_relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    //
+    // Thread local storage
+    //
+
+    bool platform_tls_key_create(PlatformTlsKey* key)
+    {
+        pthread_key_t pthreadKey;
+        const bool isCreated = ::pthread_key_create(&pthreadKey, nullptr) == 0;
+        *key = PlatformTlsKey(pthreadKey);
+        return isCreated;
+    }
+
+    void platform_tls_key_destroy(PlatformTlsKey key)
+    {
+        ::pthread_key_delete(pthread_key_t(key));
+    }
+
+    void* platform_tls_get(PlatformTlsKey key)
+    {
+        return ::pthread_getspecific(pthread_key_t(key));
+    }
+
+    void platform_tls_set(PlatformTlsKey key, void* value)
+    {
+        ::pthread_setspecific(pthread_key_t(key), value);
+    }
+
+    //
+    // Wait on address
+    //
+
+    // @NOTE :  Futex operates on the lower 32 bits of the atomic, which are its value on little-endian machines
+    void platform_wait_on_address(Atomic<u32>* atomic, u32 expectedValue)
+    {
+        platform_futex_wait((u32*)&atomic->value, expectedValue);
+    }
+
+    void platform_wake_by_address_single(Atomic<u32>* atomic)
+    {
+        platform_futex_wake((u32*)&atomic->value, 1);
+    }
+
+    void platform_wake_by_address_all(Atomic<u32>* atomic)
+    {
+        platform_futex_wake((u32*)&atomic->value, 0x7FFFFFFF);
+    }
+
+    //
+    // Mutex
+    // Based on "Futexes Are Tricky" by Ulrich Drepper (https://www.akkadia.org/drepper/futex.pdf)
+    //
+
+    void platform_mutex_construct(PlatformMutex* mutex)
+    {
+        mutex->state = 0;
+    }
+
+    void platform_mutex_destroy(PlatformMutex* mutex)
+    {
+        // Futex doesn't own any kernel resources
+    }
+
+    void platform_mutex_lock(PlatformMutex* mutex)
+    {
+        u32 state = 0;
+        if (__atomic_compare_exchange_n(&mutex->state, &state, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            return;
+        }
+        // Mutex is contended. State 2 tells the owner that it must wake somebody up on unlock.
+        if (state != 2)
+        {
+            state = __atomic_exchange_n(&mutex->state, 2, __ATOMIC_ACQUIRE);
+        }
+        while (state != 0)
+        {
+            platform_futex_wait(&mutex->state, 2);
+            state = __atomic_exchange_n(&mutex->state, 2, __ATOMIC_ACQUIRE);
+        }
+    }
+
+    bool platform_mutex_try_lock(PlatformMutex* mutex)
+    {
+        u32 state = 0;
+        return __atomic_compare_exchange_n(&mutex->state, &state, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+    }
+
+    void platform_mutex_unlock(PlatformMutex* mutex)
+    {
+        if (__atomic_exchange_n(&mutex->state, 0, __ATOMIC_RELEASE) == 2)
+        {
+            platform_futex_wake(&mutex->state, 1);
+        }
+    }
+
+    //
+    // Event
+    //
+
+    void platform_event_construct(PlatformEvent* event, bool isSignaled)
+    {
+        event->state = isSignaled ? 1 : 0;
+    }
+
+    void platform_event_destroy(PlatformEvent* event)
+    {
+        // Futex doesn't own any kernel resources
+    }
+
+    void platform_event_signal(PlatformEvent* event)
+    {
+        if (__atomic_exchange_n(&event->state, 1, __ATOMIC_RELEASE) == 2)
+        {
+            platform_futex_wake(&event->state, 0x7FFFFFFF);
+        }
+    }
+
+    void platform_event_reset(PlatformEvent* event)
+    {
+        // If state is 2 event is already not signaled and waiters flag must be kept
+        u32 state = 1;
+        __atomic_compare_exchange_n(&event->state, &state, 0, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    }
+
+    void platform_event_wait(PlatformEvent* event)
+    {
+        while (true)
+        {
+            u32 state = __atomic_load_n(&event->state, __ATOMIC_ACQUIRE);
+            if (state == 1)
+            {
+                return;
+            }
+            if (state == 0 && !__atomic_compare_exchange_n(&event->state, &state, 2, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                continue;
+            }
+            platform_futex_wait(&event->state, 2);
+        }
+    }
+
+    //
+    // Semaphore
+    //
+
+    void platform_semaphore_construct(PlatformSemaphore* semaphore, u32 initialCount)
+    {
+        semaphore->count = initialCount;
+        semaphore->numWaiters = 0;
+    }
+
+    void platform_semaphore_destroy(PlatformSemaphore* semaphore)
+    {
+        // Futex doesn't own any kernel resources
+    }
+
+    void platform_semaphore_signal(PlatformSemaphore* semaphore, u32 count)
+    {
+        __atomic_add_fetch(&semaphore->count, count, __ATOMIC_SEQ_CST);
+        // Kernel is entered only if somebody may be sleeping
+        if (__atomic_load_n(&semaphore->numWaiters, __ATOMIC_SEQ_CST) > 0)
+        {
+            platform_futex_wake(&semaphore->count, count);
+        }
+    }
+
+    void platform_semaphore_wait(PlatformSemaphore* semaphore)
+    {
+        while (true)
+        {
+            u32 count = __atomic_load_n(&semaphore->count, __ATOMIC_RELAXED);
+            while (count > 0)
+            {
+                if (__atomic_compare_exchange_n(&semaphore->count, &count, count - 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                {
+                    return;
+                }
+            }
+            // Waiter is registered before sleeping, and futex rechecks the count, so signal can't be missed
+            __atomic_add_fetch(&semaphore->numWaiters, 1, __ATOMIC_SEQ_CST);
+            platform_futex_wait(&semaphore->count, 0);
+            __atomic_sub_fetch(&semaphore->numWaiters, 1, __ATOMIC_SEQ_CST);
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef AL_PLATFORM_THREADS_LINUX_H
+#define AL_PLATFORM_THREADS_LINUX_H
+
+#include "platform_linux_backend.h"
+#include "../platform_threads.h"
+
+namespace al
+{
+    struct PlatformThread
+    {
+        pthread_t handle;
+        PlatformThreadFunction function;
+        void* userData;
+    };
+
+    // @NOTE :  0 - unlocked, 1 - locked, 2 - locked and some threads may sleep on the futex
+    struct PlatformMutex
+    {
+        u32 state;
+    };
+
+    // @NOTE :  0 - not signaled, 1 - signaled, 2 - not signaled and some threads may sleep on the futex
+    struct PlatformEvent
+    {
+        u32 state;
+    };
+
+    struct PlatformSemaphore
+    {
+        u32 count;
+        u32 numWaiters;
+    };
+}
+
+#endif
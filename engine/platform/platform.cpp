@@ -6,7 +6,14 @@
 #   include "engine/platform/win32/platform_window_win32.cpp"
 #   include "engine/platform/win32/platform_file_system_win32.cpp"
 #   include "engine/platform/win32/platform_threads_win32.cpp"
+#   include "engine/platform/win32/platform_fibers_win32.cpp"
 #   include "engine/platform/win32/platform_atomics_win32.cpp"
+#   include "engine/platform/win32/platform_memory_win32.cpp"
+#elif defined(__linux__)
+#   include "engine/platform/linux/platform_threads_linux.cpp"
+#   include "engine/platform/linux/platform_fibers_linux.cpp"
+#   include "engine/platform/linux/platform_atomics_linux.cpp"
+#   include "engine/platform/linux/platform_memory_linux.cpp"
 #else
 #   error Unsupported platform
 #endif
@@ -6,6 +6,8 @@
 #include "engine/platform/platform_file_system_config.h"
 #include "engine/platform/platform_file_system.h"
 #include "engine/platform/platform_threads.h"
+#include "engine/platform/platform_fibers.h"
+#include "engine/platform/platform_memory.h"
 #include "platform_atomics.h"
 
 #ifdef _WIN32
@@ -13,6 +15,13 @@
 #   include "engine/platform/win32/platform_window_win32.h"
 #   include "engine/platform/win32/platform_file_system_win32.h"
 #   include "engine/platform/win32/platform_threads_win32.h"
+#   include "engine/platform/win32/platform_fibers_win32.h"
+#   include "engine/platform/win32/platform_memory_win32.h"
+#elif defined(__linux__)
+    // @TODO :  Linux backend has no input, window and file system implementations yet
+#   include "engine/platform/linux/platform_threads_linux.h"
+#   include "engine/platform/linux/platform_fibers_linux.h"
+#   include "engine/platform/linux/platform_memory_linux.h"
 #else
 #   error Unsupported platform
 #endif
@@ -24,6 +24,8 @@ namespace al
     template<typename T>
     struct Atomic;
 
+    // @NOTE :  Values narrower than 8 bytes are padded to 8 bytes. Compare-exchange of such values compares and replaces
+    //          only the value bytes, so padding can never make it fail or succeed (narrow flags which threads wait on rely on this).
     template<typename T> Result<T>      platform_atomic_64_bit_increment(Atomic<T>* atomic);
     template<typename T> Result<T>      platform_atomic_64_bit_decrement(Atomic<T>* atomic);
     template<typename T> Result<T>      platform_atomic_64_bit_add      (Atomic<T>* atomic, T other);
@@ -0,0 +1,22 @@
+#ifndef AL_PLATFORM_FIBERS_H
+#define AL_PLATFORM_FIBERS_H
+
+#include "engine/types.h"
+
+namespace al
+{
+    using PlatformFiberFunction = void (*)(void* userData);
+
+    struct PlatformFiber;
+
+    // @NOTE :  Thread must be converted to a fiber before it can switch to other fibers.
+    //          Fiber function must never return, it must switch to some other fiber instead.
+    //          Fiber objects must not be moved while fiber exists.
+    bool platform_fiber_convert_current_thread  (PlatformFiber* fiber);
+    void platform_fiber_convert_back_to_thread  (PlatformFiber* fiber);
+    bool platform_fiber_create                  (PlatformFiber* fiber, uSize stackSizeBytes, PlatformFiberFunction function, void* userData);
+    void platform_fiber_destroy                 (PlatformFiber* fiber);
+    void platform_fiber_switch                  (PlatformFiber* from, PlatformFiber* to);
+}
+
+#endif
@@ -3,6 +3,8 @@
 
 #ifdef _WIN32
 #   define AL_PATH_SEPARATOR "\\"
+#elif defined(__linux__)
+#   define AL_PATH_SEPARATOR "/"
 #else
 #   error Unsupported platform
 #endif
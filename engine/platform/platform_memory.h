@@ -0,0 +1,17 @@
+#ifndef AL_PLATFORM_MEMORY_H
+#define AL_PLATFORM_MEMORY_H
+
+#include "engine/types.h"
+
+namespace al
+{
+    // @NOTE :  Reserved memory is not accessible until it is commited.
+    //          All pointers and sizes passed to commit and decommit must be page-aligned.
+    uSize   platform_memory_get_page_size   ();
+    void*   platform_memory_reserve         (uSize sizeBytes);
+    bool    platform_memory_commit          (void* ptr, uSize sizeBytes);
+    void    platform_memory_decommit        (void* ptr, uSize sizeBytes);
+    void    platform_memory_release         (void* ptr, uSize sizeBytes);
+}
+
+#endif
@@ -2,13 +2,68 @@
 #define AL_PLATFORM_THREADS_H
 
 #include "engine/types.h"
+#include "engine/platform/platform_atomics.h"
 
 namespace al
 {
     using PlatformThreadId = u64;
+    using PlatformThreadFunction = void (*)(void* userData);
+    using PlatformTlsKey = u64;
+
+    struct PlatformThread;
+    struct PlatformMutex;
+    struct PlatformEvent;
+    struct PlatformSemaphore;
 
     PlatformThreadId platform_get_current_thread_id();
     void platform_thread_yield();
+
+    bool platform_thread_create(PlatformThread* thread, PlatformThreadFunction function, void* userData);
+    void platform_thread_join(PlatformThread* thread);
+    // @NOTE :  Pins thread to a single logical core. Core index is wrapped around the number of logical cores.
+    bool platform_thread_set_affinity(PlatformThread* thread, uSize coreIndex);
+    // @NOTE :  Name is used only by debuggers and profilers. Some platforms truncate long names (Linux keeps 15 characters).
+    void platform_thread_set_name(PlatformThread* thread, const char* name);
+    uSize platform_get_logical_core_count();
+
+    // @NOTE :  OS-provided thread local storage slot. Value of a new key is nullptr in every thread.
+    //          Unlike compiler thread_local variables, address of the value is never cached by the compiler,
+    //          so keys stay correct in code running on fibers, which can be resumed on a different thread.
+    bool  platform_tls_key_create   (PlatformTlsKey* key);
+    void  platform_tls_key_destroy  (PlatformTlsKey key);
+    void* platform_tls_get          (PlatformTlsKey key);
+    void  platform_tls_set          (PlatformTlsKey key, void* value);
+
+    // @NOTE :  Hints the processor that the thread is spinning. Unlike yield, never enters the kernel.
+    void platform_cpu_relax();
+
+    // @NOTE :  Blocks while the atomic is equal to the expected value (futex on Linux, WaitOnAddress on Win32).
+    //          Wait can end spuriously, so it must be called in a loop which rechecks the value.
+    //          Wake calls don't change the value, it must be stored before waking waiters up.
+    void platform_wait_on_address          (Atomic<u32>* atomic, u32 expectedValue);
+    void platform_wake_by_address_single   (Atomic<u32>* atomic);
+    void platform_wake_by_address_all      (Atomic<u32>* atomic);
+
+    // @NOTE :  Mutex is not recursive. Uncontended lock and unlock never enter the kernel.
+    void platform_mutex_construct   (PlatformMutex* mutex);
+    void platform_mutex_destroy     (PlatformMutex* mutex);
+    void platform_mutex_lock        (PlatformMutex* mutex);
+    bool platform_mutex_try_lock    (PlatformMutex* mutex);
+    void platform_mutex_unlock      (PlatformMutex* mutex);
+
+    // @NOTE :  Manual-reset event. Signal wakes all waiting threads and event stays signaled until it is reset.
+    void platform_event_construct   (PlatformEvent* event, bool isSignaled = false);
+    void platform_event_destroy     (PlatformEvent* event);
+    void platform_event_signal      (PlatformEvent* event);
+    void platform_event_reset       (PlatformEvent* event);
+    void platform_event_wait        (PlatformEvent* event);
+
+    // @NOTE :  Counting semaphore. Signal increments the count and wakes up to "count" waiting threads,
+    //          wait blocks until the count is positive and decrements it.
+    void platform_semaphore_construct   (PlatformSemaphore* semaphore, u32 initialCount = 0);
+    void platform_semaphore_destroy     (PlatformSemaphore* semaphore);
+    void platform_semaphore_signal      (PlatformSemaphore* semaphore, u32 count = 1);
+    void platform_semaphore_wait        (PlatformSemaphore* semaphore);
 }
 
 #endif
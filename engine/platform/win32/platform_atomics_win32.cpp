@@ -1,4 +1,6 @@
 
+#include <cstring>
+
 #include "../platform_atomics.h"
 #include "platform_win32_backend.h"
 
@@ -62,9 +64,42 @@ namespace al
     Result<bool> platform_atomic_64_bit_cas(Atomic<T>* atomic, T* expected, T newValue, MemoryOrder memoryOrder)
     {
         dbg (if (!atomic) return err<bool>("Value was a nullptr."));
-        T val = *expected;
-        s64 casResult = InterlockedCompareExchange64((volatile s64*)&atomic->value, bit_cast<s64>(newValue), bit_cast<s64>(*expected));
-        *expected = bit_cast<T>(casResult);
-        return ok<bool>(val == *expected);
+        if constexpr (sizeof(T) == 8)
+        {
+            const s64 comparand = bit_cast<s64>(*expected);
+            const s64 casResult = InterlockedCompareExchange64((volatile s64*)&atomic->value, bit_cast<s64>(newValue), comparand);
+            *expected = bit_cast<T>(casResult);
+            return ok<bool>(casResult == comparand);
+        }
+        else
+        {
+            //
+            // Narrow value shares the 64-bit word with the padding of Atomic<T>, which must not take part in the comparison.
+            // Comparand and new value are built from the padding currently in memory, and if only the padding has changed
+            // in the meantime (for example increment carried into it) exchange is simply retried.
+            //
+            constexpr u64 VALUE_MASK = (u64(1) << (sizeof(T) * 8)) - 1;
+            u64 expectedBits = 0;
+            u64 newBits = 0;
+            std::memcpy(&expectedBits, expected, sizeof(T));
+            std::memcpy(&newBits, &newValue, sizeof(T));
+            u64 current = *((volatile u64*)&atomic->value);
+            while (true)
+            {
+                const u64 comparand = (current & ~VALUE_MASK) | expectedBits;
+                const u64 exchange = (current & ~VALUE_MASK) | newBits;
+                const u64 casResult = u64(InterlockedCompareExchange64((volatile s64*)&atomic->value, s64(exchange), s64(comparand)));
+                if (casResult == comparand)
+                {
+                    return ok<bool>(true);
+                }
+                if ((casResult & VALUE_MASK) != expectedBits)
+                {
+                    std::memcpy(expected, &casResult, sizeof(T));
+                    return ok<bool>(false);
+                }
+                current = casResult;
+            }
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,45 @@
+
+#include "platform_fibers_win32.h"
+
+namespace al
+{
+    VOID CALLBACK platform_fiber_entry(LPVOID parameter)
+    {
+        PlatformFiber* fiber = static_cast<PlatformFiber*>(parameter);
+        fiber->function(fiber->userData);
+    }
+
+    bool platform_fiber_convert_current_thread(PlatformFiber* fiber)
+    {
+        fiber->handle = ::ConvertThreadToFiber(nullptr);
+        fiber->function = nullptr;
+        fiber->userData = nullptr;
+        return fiber->handle != nullptr;
+    }
+
+    void platform_fiber_convert_back_to_thread(PlatformFiber* fiber)
+    {
+        ::ConvertFiberToThread();
+        fiber->handle = nullptr;
+    }
+
+    bool platform_fiber_create(PlatformFiber* fiber, uSize stackSizeBytes, PlatformFiberFunction function, void* userData)
+    {
+        fiber->function = function;
+        fiber->userData = userData;
+        fiber->handle = ::CreateFiber(stackSizeBytes, platform_fiber_entry, fiber);
+        return fiber->handle != nullptr;
+    }
+
+    void platform_fiber_destroy(PlatformFiber* fiber)
+    {
+        ::DeleteFiber(fiber->handle);
+        fiber->handle = nullptr;
+    }
+
+    void platform_fiber_switch(PlatformFiber* from, PlatformFiber* to)
+    {
+        // Windows keeps track of the current fiber itself
+        ::SwitchToFiber(to->handle);
+    }
+}
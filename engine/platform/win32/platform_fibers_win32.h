@@ -0,0 +1,17 @@
+#ifndef AL_PLATFORM_FIBERS_WIN32_H
+#define AL_PLATFORM_FIBERS_WIN32_H
+
+#include "platform_win32_backend.h"
+#include "../platform_fibers.h"
+
+namespace al
+{
+    struct PlatformFiber
+    {
+        void* handle;
+        PlatformFiberFunction function;
+        void* userData;
+    };
+}
+
+#endif
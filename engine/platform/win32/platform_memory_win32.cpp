@@ -0,0 +1,33 @@
+
+#include "platform_memory_win32.h"
+
+namespace al
+{
+    uSize platform_memory_get_page_size()
+    {
+        SYSTEM_INFO systemInfo;
+        ::GetSystemInfo(&systemInfo);
+        return uSize(systemInfo.dwPageSize);
+    }
+
+    void* platform_memory_reserve(uSize sizeBytes)
+    {
+        return ::VirtualAlloc(nullptr, sizeBytes, MEM_RESERVE, PAGE_NOACCESS);
+    }
+
+    bool platform_memory_commit(void* ptr, uSize sizeBytes)
+    {
+        return ::VirtualAlloc(ptr, sizeBytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+    }
+
+    void platform_memory_decommit(void* ptr, uSize sizeBytes)
+    {
+        ::VirtualFree(ptr, sizeBytes, MEM_DECOMMIT);
+    }
+
+    void platform_memory_release(void* ptr, uSize sizeBytes)
+    {
+        // Size must be zero when releasing the whole reserved region
+        ::VirtualFree(ptr, 0, MEM_RELEASE);
+    }
+}
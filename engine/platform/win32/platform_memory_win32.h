@@ -0,0 +1,12 @@
+#ifndef AL_PLATFORM_MEMORY_WIN32_H
+#define AL_PLATFORM_MEMORY_WIN32_H
+
+#include "platform_win32_backend.h"
+#include "../platform_memory.h"
+
+namespace al
+{
+
+}
+
+#endif
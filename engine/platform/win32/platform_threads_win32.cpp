@@ -1,6 +1,11 @@
 
 #include "platform_threads_win32.h"
 
+#ifdef _MSC_VER
+    // WaitOnAddress and WakeByAddress functions
+#   pragma comment(lib, "Synchronization.lib")
+#endif
+
 namespace al
 {
     PlatformThreadId platform_get_current_thread_id()
@@ -12,4 +17,186 @@ namespace al
     {
         ::SwitchToThread();
     }
+
+    DWORD WINAPI platform_thread_entry(LPVOID parameter)
+    {
+        PlatformThread* thread = static_cast<PlatformThread*>(parameter);
+        thread->function(thread->userData);
+        return 0;
+    }
+
+    bool platform_thread_create(PlatformThread* thread, PlatformThreadFunction function, void* userData)
+    {
+        thread->function = function;
+        thread->userData = userData;
+        thread->handle = ::CreateThread(nullptr, 0, platform_thread_entry, thread, 0, nullptr);
+        return thread->handle != nullptr;
+    }
+
+    void platform_thread_join(PlatformThread* thread)
+    {
+        ::WaitForSingleObject(thread->handle, INFINITE);
+        ::CloseHandle(thread->handle);
+        thread->handle = nullptr;
+    }
+
+    bool platform_thread_set_affinity(PlatformThread* thread, uSize coreIndex)
+    {
+        // @NOTE : affinity mask covers only the current processor group (up to 64 logical cores)
+        const uSize numCores = platform_get_logical_core_count();
+        const uSize core = (coreIndex % numCores) % 64;
+        return ::SetThreadAffinityMask(thread->handle, DWORD_PTR(1) << core) != 0;
+    }
+
+    void platform_thread_set_name(PlatformThread* thread, const char* name)
+    {
+        wchar_t wideName[64];
+        const int length = ::MultiByteToWideChar(CP_UTF8, 0, name, -1, wideName, 64);
+        if (length == 0)
+        {
+            return;
+        }
+        ::SetThreadDescription(thread->handle, wideName);
+    }
+
+    uSize platform_get_logical_core_count()
+    {
+        SYSTEM_INFO systemInfo;
+        ::GetSystemInfo(&systemInfo);
+        return uSize(systemInfo.dwNumberOfProcessors);
+    }
+
+    void platform_cpu_relax()
+    {
+        ::YieldProcessor();
+    }
+
+    //
+    // Thread local storage
+    //
+
+    bool platform_tls_key_create(PlatformTlsKey* key)
+    {
+        const DWORD index = ::TlsAlloc();
+        *key = PlatformTlsKey(index);
+        return index != TLS_OUT_OF_INDEXES;
+    }
+
+    void platform_tls_key_destroy(PlatformTlsKey key)
+    {
+        ::TlsFree(DWORD(key));
+    }
+
+    void* platform_tls_get(PlatformTlsKey key)
+    {
+        return ::TlsGetValue(DWORD(key));
+    }
+
+    void platform_tls_set(PlatformTlsKey key, void* value)
+    {
+        ::TlsSetValue(DWORD(key), value);
+    }
+
+    //
+    // Wait on address
+    //
+
+    void platform_wait_on_address(Atomic<u32>* atomic, u32 expectedValue)
+    {
+        ::WaitOnAddress(&atomic->value, &expectedValue, sizeof(u32), INFINITE);
+    }
+
+    void platform_wake_by_address_single(Atomic<u32>* atomic)
+    {
+        ::WakeByAddressSingle((PVOID)&atomic->value);
+    }
+
+    void platform_wake_by_address_all(Atomic<u32>* atomic)
+    {
+        ::WakeByAddressAll((PVOID)&atomic->value);
+    }
+
+    //
+    // Mutex
+    //
+
+    void platform_mutex_construct(PlatformMutex* mutex)
+    {
+        ::InitializeSRWLock(&mutex->lock);
+    }
+
+    void platform_mutex_destroy(PlatformMutex* mutex)
+    {
+        // SRW locks don't own any resources
+    }
+
+    void platform_mutex_lock(PlatformMutex* mutex)
+    {
+        ::AcquireSRWLockExclusive(&mutex->lock);
+    }
+
+    bool platform_mutex_try_lock(PlatformMutex* mutex)
+    {
+        return ::TryAcquireSRWLockExclusive(&mutex->lock) != 0;
+    }
+
+    void platform_mutex_unlock(PlatformMutex* mutex)
+    {
+        ::ReleaseSRWLockExclusive(&mutex->lock);
+    }
+
+    //
+    // Event
+    //
+
+    void platform_event_construct(PlatformEvent* event, bool isSignaled)
+    {
+        event->handle = ::CreateEventW(nullptr, TRUE, isSignaled ? TRUE : FALSE, nullptr);
+    }
+
+    void platform_event_destroy(PlatformEvent* event)
+    {
+        ::CloseHandle(event->handle);
+        event->handle = nullptr;
+    }
+
+    void platform_event_signal(PlatformEvent* event)
+    {
+        ::SetEvent(event->handle);
+    }
+
+    void platform_event_reset(PlatformEvent* event)
+    {
+        ::ResetEvent(event->handle);
+    }
+
+    void platform_event_wait(PlatformEvent* event)
+    {
+        ::WaitForSingleObject(event->handle, INFINITE);
+    }
+
+    //
+    // Semaphore
+    //
+
+    void platform_semaphore_construct(PlatformSemaphore* semaphore, u32 initialCount)
+    {
+        semaphore->handle = ::CreateSemaphoreW(nullptr, LONG(initialCount), LONG(0x7FFFFFFF), nullptr);
+    }
+
+    void platform_semaphore_destroy(PlatformSemaphore* semaphore)
+    {
+        ::CloseHandle(semaphore->handle);
+        semaphore->handle = nullptr;
+    }
+
+    void platform_semaphore_signal(PlatformSemaphore* semaphore, u32 count)
+    {
+        ::ReleaseSemaphore(semaphore->handle, LONG(count), nullptr);
+    }
+
+    void platform_semaphore_wait(PlatformSemaphore* semaphore)
+    {
+        ::WaitForSingleObject(semaphore->handle, INFINITE);
+    }
 }
@@ -6,7 +6,27 @@
 
 namespace al
 {
+    struct PlatformThread
+    {
+        HANDLE handle;
+        PlatformThreadFunction function;
+        void* userData;
+    };
 
+    struct PlatformMutex
+    {
+        SRWLOCK lock;
+    };
+
+    struct PlatformEvent
+    {
+        HANDLE handle;
+    };
+
+    struct PlatformSemaphore
+    {
+        HANDLE handle;
+    };
 }
 
 #endif
@@ -22,6 +22,7 @@ namespace al
     struct CommandBufferRequestInfo;
     struct CommandBindPipelineInfo;
     struct CommandDrawInfo;
+    struct AllocatorBindings;
 
     struct RenderApiVtable
     {
@@ -33,6 +34,7 @@ namespace al
         uSize                   (*get_active_swap_chain_texture_index)  (RenderDevice* device);
         void                    (*begin_frame)                          (RenderDevice* device);
         void                    (*end_frame)                            (RenderDevice* device);
+        AllocatorBindings*      (*get_in_flight_frame_allocator)        (RenderDevice* device);
         RenderProgram*          (*program_create)                       (RenderProgramCreateInfo* createInfo);
         void                    (*program_destroy)                      (RenderProgram* program);
         Texture*                (*texture_create)                       (TextureCreateInfo* createInfo);
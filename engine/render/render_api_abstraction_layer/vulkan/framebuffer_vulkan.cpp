@@ -23,9 +23,9 @@ namespace al
         //
         // Temp data
         //
-        Array<VkImageView> attachmentViews;
-        array_construct(&attachmentViews, &device->memoryManager.cpu_frameAllocator, createInfo->attachments.size);
-        defer(array_destruct(&attachmentViews));
+        SmallArray<VkImageView, 8> attachmentViews;
+        small_array_construct(&attachmentViews, &device->memoryManager.cpu_frameAllocator, createInfo->attachments.size);
+        defer(small_array_destruct(&attachmentViews));
         for (al_iterator(it, createInfo->attachments))
         {
             TextureVulkan* texture = (TextureVulkan*)*get(it);
@@ -41,7 +41,7 @@ namespace al
             .flags              = 0,
             .renderPass         = pass->handle,
             .attachmentCount    = u32(attachmentViews.size),
-            .pAttachments       = attachmentViews.memory,
+            .pAttachments       = small_array_data(&attachmentViews),
             .width              = ((TextureVulkan*)createInfo->attachments[0])->extent.width,
             .height             = ((TextureVulkan*)createInfo->attachments[0])->extent.height,
             .layers             = 1,
@@ -23,6 +23,7 @@ namespace al
             .get_active_swap_chain_texture_index    = vulkan_get_active_swap_chain_texture_index,
             .begin_frame                            = vulkan_begin_frame,
             .end_frame                              = vulkan_end_frame,
+            .get_in_flight_frame_allocator          = vulkan_get_in_flight_frame_allocator,
             .program_create                         = vulkan_render_program_create,
             .program_destroy                        = vulkan_render_program_destroy,
             .texture_create                         = vulkan_texture_create,
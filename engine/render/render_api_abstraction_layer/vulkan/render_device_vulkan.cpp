@@ -502,6 +502,8 @@ namespace al
         {
             al_vk_check(vkCreateSemaphore(device, &semaphoreCreateInfo, createInfo->allocationCallbacks, &get(it)->imageAvailableSemaphore));
             dynamic_array_construct(&get(it)->commandBuffers, createInfo->persistenAllocator);
+            construct_virtual(&get(it)->frameAllocator, EngineConfig::IN_FLIGHT_FRAME_ALLOCATOR_RESERVE_SIZE, EngineConfig::IN_FLIGHT_FRAME_ALLOCATOR_MEMORY_SIZE);
+            get(it)->frameAllocatorBindings = get_allocator_bindings(&get(it)->frameAllocator);
         }
         array_construct(&data->swapChainImageToInFlightFrameMap, createInfo->persistenAllocator, createInfo->swapChain->images.size);
         for (al_iterator(it, data->swapChainImageToInFlightFrameMap))
@@ -523,6 +525,7 @@ namespace al
             {
                 vulkan_command_buffer_destroy(*buf);
             });
+            destruct(&perImageData->frameAllocator);
         }
         array_destruct(&data->swapChainImageToInFlightFrameMap);
     }
@@ -531,7 +534,7 @@ namespace al
     {
         /*
             1. Advance in flight index
-            2. Wait until previous command buffers of this frame finish execution
+            2. Wait until previous command buffers of this frame finish execution and reset frame allocator
             3. Acquire next image and set the image semaphore to wait for
             4. If this image is already used by another in flight frame, wait for it's execution fence too
             5. Save in flight frame reference to tha map
@@ -542,6 +545,8 @@ namespace al
         {
             vkWaitForFences(device, 1, &(*activeFrameCommandBuffers)[activeFrameCommandBuffers->size - 1]->executionFence, VK_TRUE, UINT64_MAX);
         }
+        // Everything allocated during this frame in flight is no longer used by gpu
+        stack_alloactor_reset(&data->inFlightData[data->activeFrameInFlightIndex].frameAllocator);
         al_vk_check(vkAcquireNextImageKHR(device, swapChain->handle, UINT64_MAX, data->inFlightData[data->activeFrameInFlightIndex].imageAvailableSemaphore, VK_NULL_HANDLE, &data->activeSwapChainImageIndex));
         const u32 inFlightFrameReferencedBySwapChainImage = data->swapChainImageToInFlightFrameMap[data->activeSwapChainImageIndex];
         if (inFlightFrameReferencedBySwapChainImage != VulkanInFlightData::UNUSED_IN_FLIGHT_DATA_REF)
@@ -707,4 +712,10 @@ namespace al
         };
         al_vk_check(vkQueuePresentKHR(get_command_queue(&device->gpu, VulkanGpu::CommandQueue::PRESENT)->handle, &presentInfo));
     }
+
+    AllocatorBindings* vulkan_get_in_flight_frame_allocator(RenderDevice* _device)
+    {
+        RenderDeviceVulkan* device = (RenderDeviceVulkan*)_device;
+        return &vulkan_in_flight_data_get_current(&device->inFlightData)->frameAllocatorBindings;
+    }
 }
@@ -127,6 +127,9 @@ namespace al
         commandBuffers -                    all command buffers submitted to this image in flight
         imageAvailableSemaphore -           fires when swap chain image, used by a given inFlightData,
                                             becomes available
+        frameAllocator -                    stack allocator for data which must live until GPU finishes
+                                            this frame in flight. Reset only after the frame's fence
+                                            has signaled
     */
     struct VulkanInFlightData
     {
@@ -134,6 +137,8 @@ namespace al
         {
             DynamicArray<CommandBufferVulkan*> commandBuffers;
             VkSemaphore imageAvailableSemaphore;
+            StackAllocator frameAllocator;
+            AllocatorBindings frameAllocatorBindings;
         };
         static constexpr u32 UNUSED_IN_FLIGHT_DATA_REF = ~u32(0);
         static constexpr u32 NUM_IMAGES_IN_FLIGHT = 3;
@@ -183,6 +188,7 @@ namespace al
     uSize vulkan_get_active_swap_chain_texture_index(RenderDevice* device);
     void vulkan_begin_frame(RenderDevice* device);
     void vulkan_end_frame(RenderDevice* device);
+    AllocatorBindings* vulkan_get_in_flight_frame_allocator(RenderDevice* device);
 }
 
 #endif
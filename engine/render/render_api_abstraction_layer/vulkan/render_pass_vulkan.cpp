@@ -11,18 +11,23 @@
 
 namespace al
 {
+    // @NOTE : Inline capacities cover usual render passes, bigger ones spill to the frame allocator
+    static constexpr uSize RENDER_PASS_INLINE_ATTACHMENTS = 8;
+    static constexpr uSize RENDER_PASS_INLINE_SUBPASSES = 4;
+    static constexpr uSize RENDER_PASS_INLINE_DEPENDENCIES = 8;
+
     struct SubpassIntermediateData
     {
-        Array<VkAttachmentReference> colorAttachmentRefs;
-        Array<VkAttachmentReference> inputAttachmentRefs;
-        Array<VkAttachmentReference> resolveAttachmentRefs;
-        Array<u32> preserveAttachmentRefs;
+        SmallArray<VkAttachmentReference, RENDER_PASS_INLINE_ATTACHMENTS> colorAttachmentRefs;
+        SmallArray<VkAttachmentReference, RENDER_PASS_INLINE_ATTACHMENTS> inputAttachmentRefs;
+        SmallArray<VkAttachmentReference, RENDER_PASS_INLINE_ATTACHMENTS> resolveAttachmentRefs;
+        SmallArray<u32, RENDER_PASS_INLINE_ATTACHMENTS> preserveAttachmentRefs;
         VkAttachmentReference depthStencilReference;
     };
 
-    VkAttachmentReference* vulkan_find_attachment_reference(Array<VkAttachmentReference> refs, u32 attachmentIndex)
+    VkAttachmentReference* vulkan_find_attachment_reference(SmallArray<VkAttachmentReference, RENDER_PASS_INLINE_ATTACHMENTS>* refs, u32 attachmentIndex)
     {
-        for (al_iterator(it, refs))
+        for (al_iterator(it, *refs))
         {
             if (get(it)->attachment == attachmentIndex)
             {
@@ -52,9 +57,9 @@ namespace al
         const bool hasDepthStencilAttachment = createInfo->depthStencilAttachment != nullptr;
         const VkSampleCountFlags supprotedAttachmentSampleCounts = vulkan_gpu_get_supported_framebuffer_multisample_types(&device->gpu);
 
-        Array<VkAttachmentDescription> renderPassAttachmentDescriptions;
-        array_construct(&renderPassAttachmentDescriptions, &device->memoryManager.cpu_frameAllocator, createInfo->colorAttachments.size + (hasDepthStencilAttachment ? 1 : 0));
-        defer(array_destruct(&renderPassAttachmentDescriptions));
+        SmallArray<VkAttachmentDescription, RENDER_PASS_INLINE_ATTACHMENTS> renderPassAttachmentDescriptions;
+        small_array_construct(&renderPassAttachmentDescriptions, &device->memoryManager.cpu_frameAllocator, createInfo->colorAttachments.size + (hasDepthStencilAttachment ? 1 : 0));
+        defer(small_array_destruct(&renderPassAttachmentDescriptions));
 
         al_assert(renderPassAttachmentDescriptions.size <= RenderPassCreateInfo::MAX_ATTACHMENTS);
 
@@ -105,22 +110,23 @@ namespace al
         // Subpasses
         //
 
-        Array<SubpassIntermediateData> subpassIntermediateDatas;
-        Array<VkSubpassDescription> subpassDescriptions;
-        array_construct(&subpassIntermediateDatas, &device->memoryManager.cpu_frameAllocator, createInfo->subpasses.size);
-        array_construct(&subpassDescriptions, &device->memoryManager.cpu_frameAllocator, createInfo->subpasses.size);
+        // @NOTE : Subpass descriptions point to the inline storage of intermediate datas, so these arrays must never grow
+        SmallArray<SubpassIntermediateData, RENDER_PASS_INLINE_SUBPASSES> subpassIntermediateDatas;
+        SmallArray<VkSubpassDescription, RENDER_PASS_INLINE_SUBPASSES> subpassDescriptions;
+        small_array_construct(&subpassIntermediateDatas, &device->memoryManager.cpu_frameAllocator, createInfo->subpasses.size);
+        small_array_construct(&subpassDescriptions, &device->memoryManager.cpu_frameAllocator, createInfo->subpasses.size);
         defer
         (
             for (al_iterator(it, subpassIntermediateDatas))
             {
-                if (get(it)->colorAttachmentRefs.size) array_destruct(&get(it)->colorAttachmentRefs);
-                if (get(it)->inputAttachmentRefs.size) array_destruct(&get(it)->inputAttachmentRefs);
-                if (get(it)->resolveAttachmentRefs.size) array_destruct(&get(it)->resolveAttachmentRefs);
-                if (get(it)->preserveAttachmentRefs.size) array_destruct(&get(it)->preserveAttachmentRefs);
+                small_array_destruct(&get(it)->colorAttachmentRefs);
+                small_array_destruct(&get(it)->inputAttachmentRefs);
+                small_array_destruct(&get(it)->resolveAttachmentRefs);
+                small_array_destruct(&get(it)->preserveAttachmentRefs);
             }
-            array_destruct(&subpassIntermediateDatas);
+            small_array_destruct(&subpassIntermediateDatas);
         );
-        defer(array_destruct(&subpassDescriptions));
+        defer(small_array_destruct(&subpassDescriptions));
 
         // globalUsedAttachmentsMask & 1 << attachmentIndex == 1 if attachment was already used in the render pass
         RenderPassAttachmentRefBitMask globalUsedAttachmentsMask = 0;
@@ -132,9 +138,9 @@ namespace al
             const u32 colorRefsSize = subpassCreateInfo->colorRefs.size;
             const u32 inputRefsSize = subpassCreateInfo->inputRefs.size;
             const u32 resolveRefsSize = subpassCreateInfo->resolveRefs.size;
-            if (colorRefsSize) array_construct(&subpassIntermediateData->colorAttachmentRefs, &device->memoryManager.cpu_frameAllocator, colorRefsSize);
-            if (inputRefsSize) array_construct(&subpassIntermediateData->inputAttachmentRefs, &device->memoryManager.cpu_frameAllocator, inputRefsSize);
-            if (resolveRefsSize) array_construct(&subpassIntermediateData->resolveAttachmentRefs, &device->memoryManager.cpu_frameAllocator, resolveRefsSize);
+            small_array_construct(&subpassIntermediateData->colorAttachmentRefs, &device->memoryManager.cpu_frameAllocator, colorRefsSize);
+            small_array_construct(&subpassIntermediateData->inputAttachmentRefs, &device->memoryManager.cpu_frameAllocator, inputRefsSize);
+            small_array_construct(&subpassIntermediateData->resolveAttachmentRefs, &device->memoryManager.cpu_frameAllocator, resolveRefsSize);
             // localUsedAttachmentsMask & 1 << attachmentIndex == 1 if attachment was already used in the subpass
             RenderPassAttachmentRefBitMask localUsedAttachmentsMask = 0;
             //
@@ -214,7 +220,7 @@ namespace al
                     preserveRefsMask |= RenderPassAttachmentRefBitMask(1) << attachmentIndex;
                 }
             }
-            if (preserveRefsSize) array_construct(&subpassIntermediateData->preserveAttachmentRefs, &device->memoryManager.cpu_frameAllocator, preserveRefsSize);
+            small_array_construct(&subpassIntermediateData->preserveAttachmentRefs, &device->memoryManager.cpu_frameAllocator, preserveRefsSize);
             refCounter = 0;
             al_for_each_set_bit(preserveRefsMask, preserveIt)
             {
@@ -233,13 +239,13 @@ namespace al
                 .flags                      = 0,
                 .pipelineBindPoint          = VK_PIPELINE_BIND_POINT_GRAPHICS,
                 .inputAttachmentCount       = inputRefsSize,
-                .pInputAttachments          = inputRefsSize ? subpassIntermediateData->inputAttachmentRefs.memory : nullptr,
+                .pInputAttachments          = inputRefsSize ? small_array_data(&subpassIntermediateData->inputAttachmentRefs) : nullptr,
                 .colorAttachmentCount       = colorRefsSize,
-                .pColorAttachments          = colorRefsSize ? subpassIntermediateData->colorAttachmentRefs.memory : nullptr,
-                .pResolveAttachments        = resolveRefsSize ? subpassIntermediateData->resolveAttachmentRefs.memory : nullptr,
+                .pColorAttachments          = colorRefsSize ? small_array_data(&subpassIntermediateData->colorAttachmentRefs) : nullptr,
+                .pResolveAttachments        = resolveRefsSize ? small_array_data(&subpassIntermediateData->resolveAttachmentRefs) : nullptr,
                 .pDepthStencilAttachment    = depthRef,
                 .preserveAttachmentCount    = preserveRefsSize,
-                .pPreserveAttachments       = preserveRefsSize ? subpassIntermediateData->preserveAttachmentRefs.memory : nullptr,
+                .pPreserveAttachments       = preserveRefsSize ? small_array_data(&subpassIntermediateData->preserveAttachmentRefs) : nullptr,
             };
         }
 
@@ -270,9 +276,9 @@ namespace al
             {
                 const RenderPassAttachmentRefBitMask subpassBitMask = RenderPassAttachmentRefBitMask(1) << to_index(subpassIt);
                 SubpassIntermediateData* subpass = get(subpassIt);
-                VkAttachmentReference* color    = vulkan_find_attachment_reference(subpass->colorAttachmentRefs, to_index(attachmentIt));
-                VkAttachmentReference* input    = vulkan_find_attachment_reference(subpass->inputAttachmentRefs, to_index(attachmentIt));
-                VkAttachmentReference* resolve  = vulkan_find_attachment_reference(subpass->resolveAttachmentRefs, to_index(attachmentIt));
+                VkAttachmentReference* color    = vulkan_find_attachment_reference(&subpass->colorAttachmentRefs, to_index(attachmentIt));
+                VkAttachmentReference* input    = vulkan_find_attachment_reference(&subpass->inputAttachmentRefs, to_index(attachmentIt));
+                VkAttachmentReference* resolve  = vulkan_find_attachment_reference(&subpass->resolveAttachmentRefs, to_index(attachmentIt));
                 VkAttachmentReference* depth    =   subpass->depthStencilReference.attachment != VK_ATTACHMENT_UNUSED && 
                                                     subpass->depthStencilReference.attachment == to_index(attachmentIt) ?
                                                     &subpass->depthStencilReference : nullptr;
@@ -358,9 +364,9 @@ namespace al
         const RenderPassAttachmentRefBitMask allSelfDependencies = selfColorDependencies | selfDepthDependencies;
         const uSize numberOfSubpassDependencies = countBits(allExternalDependencies) + countBits(allSelfDependencies) + subpassIntermediateDatas.size - 1;
 
-        Array<VkSubpassDependency> subpassDependencies;
-        if (numberOfSubpassDependencies) array_construct(&subpassDependencies, &device->memoryManager.cpu_frameAllocator, numberOfSubpassDependencies);
-        defer(if (numberOfSubpassDependencies) array_destruct(&subpassDependencies));
+        SmallArray<VkSubpassDependency, RENDER_PASS_INLINE_DEPENDENCIES> subpassDependencies;
+        small_array_construct(&subpassDependencies, &device->memoryManager.cpu_frameAllocator, numberOfSubpassDependencies);
+        defer(small_array_destruct(&subpassDependencies));
         uSize subpassDependencyIt = 0;
 
         al_for_each_set_bit(allExternalDependencies, it)
@@ -467,11 +473,11 @@ namespace al
             .pNext              = nullptr,
             .flags              = 0,
             .attachmentCount    = u32(renderPassAttachmentDescriptions.size),
-            .pAttachments       = renderPassAttachmentDescriptions.memory,
+            .pAttachments       = small_array_data(&renderPassAttachmentDescriptions),
             .subpassCount       = u32(subpassDescriptions.size),
-            .pSubpasses         = subpassDescriptions.memory,
-            .dependencyCount    = numberOfSubpassDependencies ? u32(subpassDependencies.size) : 0,
-            .pDependencies      = numberOfSubpassDependencies ? subpassDependencies.memory : nullptr,
+            .pSubpasses         = small_array_data(&subpassDescriptions),
+            .dependencyCount    = u32(subpassDependencies.size),
+            .pDependencies      = numberOfSubpassDependencies ? small_array_data(&subpassDependencies) : nullptr,
         };
         al_vk_check(vkCreateRenderPass(device->gpu.logicalHandle, &renderPassInfo, &device->memoryManager.cpu_allocationCallbacks, &pass->handle));
         pass->device = device;
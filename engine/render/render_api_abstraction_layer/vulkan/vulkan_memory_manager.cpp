@@ -14,31 +14,46 @@ namespace al
                 [](void* pUserData, uSize size, uSize alignment, VkSystemAllocationScope allocationScope)
                 {
                     VulkanMemoryManager* manager = static_cast<VulkanMemoryManager*>(pUserData);
-                    void* result = allocate(&manager->cpu_persistentAllocator, size);
-                    al_assert(manager->cpu_currentNumberOfAllocations < VulkanMemoryManager::MAX_CPU_ALLOCATIONS);
-                    manager->cpu_allocations[manager->cpu_currentNumberOfAllocations++] =
+                    void* result = allocate(&manager->cpu_persistentAllocator, size, alignment);
+                    if (result)
                     {
-                        .ptr = result,
-                        .size = size,
-                    };
+                        al_assert(manager->cpu_currentNumberOfAllocations < VulkanMemoryManager::MAX_CPU_ALLOCATIONS);
+                        manager->cpu_allocations[manager->cpu_currentNumberOfAllocations++] =
+                        {
+                            .ptr = result,
+                            .size = size,
+                        };
+                    }
                     return result;
                 },
             .pfnReallocation =
                 [](void* pUserData, void* pOriginal, uSize size, uSize alignment, VkSystemAllocationScope allocationScope)
                 {
                     VulkanMemoryManager* manager = static_cast<VulkanMemoryManager*>(pUserData);
+                    // Vulkan requires realloc semantics : null original pointer allocates, zero size frees
+                    if (!pOriginal)
+                    {
+                        return manager->cpu_allocationCallbacks.pfnAllocation(pUserData, size, alignment, allocationScope);
+                    }
+                    if (size == 0)
+                    {
+                        manager->cpu_allocationCallbacks.pfnFree(pUserData, pOriginal);
+                        return static_cast<void*>(nullptr);
+                    }
                     void* result = nullptr;
                     for (uSize it = 0; it < manager->cpu_currentNumberOfAllocations; it++)
                     {
                         if (manager->cpu_allocations[it].ptr == pOriginal)
                         {
-                            deallocate(&manager->cpu_persistentAllocator, manager->cpu_allocations[it].ptr, manager->cpu_allocations[it].size);
-                            result = allocate(&manager->cpu_persistentAllocator, size);
-                            manager->cpu_allocations[it] =
+                            result = reallocate(&manager->cpu_persistentAllocator, manager->cpu_allocations[it].ptr, manager->cpu_allocations[it].size, size, alignment);
+                            if (result)
                             {
-                                .ptr = result,
-                                .size = size,
-                            };
+                                manager->cpu_allocations[it] =
+                                {
+                                    .ptr = result,
+                                    .size = size,
+                                };
+                            }
                             break;
                         }
                     }
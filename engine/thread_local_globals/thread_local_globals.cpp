@@ -2,30 +2,39 @@
 #include "thread_local_globals.h"
 #include "engine/utilities/thread_local_storage.h"
 #include "engine/platform/platform_atomics.h"
+#include "engine/utilities/adaptive_wait.h"
 
 namespace al
 {
+    enum struct GlobalsStorageState : u32
+    {
+        NOT_CONSTRUCTED,
+        CONSTRUCTING,
+        CONSTRUCTED,
+    };
+
     ThreadLocalStorage<ApplicationGlobals*, 1024> globalsStorage;
-    Atomic<bool> isConstructed { .value = false };
-    Atomic<bool> isConstructing { .value = false };
+    Atomic<u32> globalsStorageState { .value = u32(GlobalsStorageState::NOT_CONSTRUCTED) };
+    AdaptiveWait globalsStorageWait { };
 
     void thread_local_globals_register(ApplicationGlobals* globals)
     {
-        if (!platform_atomic_64_bit_load(&isConstructed, MemoryOrder::ACQUIRE))
+        // @NOTE :  Single state variable is used, so storage can't be constructed twice by a thread
+        //          which saw it not constructed right before other thread finished construction.
+        //          State is u32 because address waits are 32-bit, compare-exchange ignores Atomic padding.
+        u32 state = platform_atomic_64_bit_load(&globalsStorageState, MemoryOrder::ACQUIRE);
+        if (state != u32(GlobalsStorageState::CONSTRUCTED))
         {
-            bool expected = false;
-            if (platform_atomic_64_bit_cas(&isConstructing, &expected, true, MemoryOrder::ACQUIRE_RELEASE))
+            state = u32(GlobalsStorageState::NOT_CONSTRUCTED);
+            if (platform_atomic_64_bit_cas(&globalsStorageState, &state, u32(GlobalsStorageState::CONSTRUCTING), MemoryOrder::ACQUIRE_RELEASE))
             {
                 tls_construct(&globalsStorage);
-                platform_atomic_64_bit_store(&isConstructed, true, MemoryOrder::RELEASE);
-                platform_atomic_64_bit_store(&isConstructing, false, MemoryOrder::RELEASE);
+                platform_atomic_64_bit_store(&globalsStorageState, u32(GlobalsStorageState::CONSTRUCTED), MemoryOrder::SEQUENTIALLY_CONSISTENT);
+                adaptive_wait_notify_all(&globalsStorageWait, &globalsStorageState);
             }
             else
             {
-                while (platform_atomic_64_bit_load(&isConstructing, MemoryOrder::ACQUIRE))
-                {
-                    platform_thread_yield();
-                }
+                adaptive_wait_while_equal(&globalsStorageWait, &globalsStorageState, u32(GlobalsStorageState::CONSTRUCTING));
             }
         }
         *tls_access(&globalsStorage) = globals;
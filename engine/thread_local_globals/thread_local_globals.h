@@ -4,10 +4,12 @@
 namespace al
 {
     struct Logger;
+    struct JobSystem;
 
     struct ApplicationGlobals
     {
         Logger* logger;
+        JobSystem* jobSystem;
     };
 
     void thread_local_globals_register(ApplicationGlobals* globals);
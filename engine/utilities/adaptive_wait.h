@@ -0,0 +1,70 @@
+#ifndef AL_ADAPTIVE_WAIT_H
+#define AL_ADAPTIVE_WAIT_H
+
+#include "engine/types.h"
+#include "engine/platform/platform_atomics.h"
+#include "engine/platform/platform_threads.h"
+
+namespace al
+{
+    //
+    // Spin-then-park wait for a single atomic value.
+    // Waiter spins for a while and parks the thread in the kernel if the value still hasn't changed.
+    // Spin limit adapts to the waits at this particular AdaptiveWait : if the value usually changes while spinning
+    // the limit grows, if waiters usually end up parked it shrinks, so long waits stop burning cores.
+    // Notifier enters the kernel only if somebody is actually parked.
+    //
+    // @NOTE :  Zero-initialized AdaptiveWait is valid, so it can be used for globals without construction.
+    //
+    struct AdaptiveWait
+    {
+        static constexpr u32 MIN_SPINS = 16;
+        static constexpr u32 MAX_SPINS = 4096;
+        Atomic<u32> spinLimit;
+        Atomic<u32> numParked;
+    };
+
+    inline void adaptive_wait_construct(AdaptiveWait* wait)
+    {
+        platform_atomic_64_bit_store(&wait->spinLimit, AdaptiveWait::MIN_SPINS, MemoryOrder::RELAXED);
+        platform_atomic_64_bit_store(&wait->numParked, u32(0), MemoryOrder::RELAXED);
+    }
+
+    // @NOTE :  Returns when the atomic is not equal to the value anymore
+    inline void adaptive_wait_while_equal(AdaptiveWait* wait, Atomic<u32>* atomic, u32 value)
+    {
+        u32 spinLimit = platform_atomic_64_bit_load(&wait->spinLimit, MemoryOrder::RELAXED);
+        spinLimit = spinLimit < AdaptiveWait::MIN_SPINS ? AdaptiveWait::MIN_SPINS : spinLimit;
+        for (u32 it = 0; it < spinLimit; it++)
+        {
+            if (platform_atomic_64_bit_load(atomic, MemoryOrder::ACQUIRE) != value)
+            {
+                // Spinning was enough, next waits can afford to spin a bit longer
+                const u32 newLimit = spinLimit + spinLimit / 8;
+                platform_atomic_64_bit_store(&wait->spinLimit, newLimit > AdaptiveWait::MAX_SPINS ? AdaptiveWait::MAX_SPINS : newLimit, MemoryOrder::RELAXED);
+                return;
+            }
+            platform_cpu_relax();
+        }
+        const u32 newLimit = spinLimit - spinLimit / 4;
+        platform_atomic_64_bit_store(&wait->spinLimit, newLimit < AdaptiveWait::MIN_SPINS ? AdaptiveWait::MIN_SPINS : newLimit, MemoryOrder::RELAXED);
+        // Waiter is counted before the value is checked again, so notifier which changed the value after the check will see it
+        platform_atomic_64_bit_increment(&wait->numParked);
+        while (platform_atomic_64_bit_load(atomic, MemoryOrder::ACQUIRE) == value)
+        {
+            platform_wait_on_address(atomic, value);
+        }
+        platform_atomic_64_bit_decrement(&wait->numParked);
+    }
+
+    // @NOTE :  New value must be stored with MemoryOrder::SEQUENTIALLY_CONSISTENT before this call
+    inline void adaptive_wait_notify_all(AdaptiveWait* wait, Atomic<u32>* atomic)
+    {
+        if (platform_atomic_64_bit_load(&wait->numParked, MemoryOrder::SEQUENTIALLY_CONSISTENT) > 0)
+        {
+            platform_wake_by_address_all(atomic);
+        }
+    }
+}
+
+#endif
@@ -65,16 +65,20 @@ namespace al
         {
             if (allocator->allocations[it].ptr == old)
             {
-                deallocate(&allocator->bindings, allocator->allocations[it].ptr, allocator->allocations[it].size);
-                result = allocate<T>(&allocator->bindings, newAmount);
-                allocator->allocations[it].ptr = result;
+                uSize newSize;
                 if constexpr (std::is_same_v<T, void>)
                 {
-                    allocator->allocations[it].size = newAmount;
+                    newSize = newAmount;
                 }
                 else
                 {
-                    allocator->allocations[it].size = sizeof(T) * newAmount;
+                    newSize = sizeof(T) * newAmount;
+                }
+                result = static_cast<T*>(reallocate(&allocator->bindings, allocator->allocations[it].ptr, allocator->allocations[it].size, newSize));
+                if (result)
+                {
+                    allocator->allocations[it].ptr = result;
+                    allocator->allocations[it].size = newSize;
                 }
                 break;
             }
@@ -3,6 +3,10 @@
 
 #include <concepts>
 
+#ifdef _MSC_VER
+#   include <intrin.h>
+#endif
+
 #include "engine/types.h"
 
 namespace al
@@ -16,6 +20,36 @@ namespace al
         return result;
     };
 
+    // @NOTE :  Result is undefined for zero values
+    inline uSize count_trailing_zeros(u64 value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return uSize(index);
+#else
+        return uSize(__builtin_ctzll(value));
+#endif
+    }
+
+    // @NOTE :  Result is undefined for zero values
+    inline uSize count_leading_zeros(u64 value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return uSize(63 - index);
+#else
+        return uSize(__builtin_clzll(value));
+#endif
+    }
+
+    // Returns the smallest power n such that 2^n >= value
+    inline uSize log2_ceil(u64 value)
+    {
+        return value <= 1 ? 0 : 64 - count_leading_zeros(value - 1);
+    }
+
     template<typename To, typename From>
     inline To bit_cast(From value)
     {
@@ -0,0 +1,391 @@
+#ifndef AL_CONCURRENT_HASH_MAP_H
+#define AL_CONCURRENT_HASH_MAP_H
+
+/*
+    Hash map for read-mostly data shared between threads (asset registries and such).
+    Workflow is as follows:
+        ConcurrentHashMap<UserKey, UserValue> map;
+        concurrent_hash_map_construct(&map, &allocatorBindings, optionalDefaultCapacity);
+        // any thread
+        bool isAdded = concurrent_hash_map_add(&map, &userKey, &userValue);   // false if key is already in the map
+        UserValue value;
+        bool isFound = concurrent_hash_map_get(&map, &userKey, &value);       // value is copied out of the map
+        bool isRemoved = concurrent_hash_map_remove(&map, &userKey);
+        // only when no other thread uses the map
+        concurrent_hash_map_free_retired_tables(&map);                        // optional, see below
+        concurrent_hash_map_destroy(&map);
+
+    Keys and values must be trivially copyable, because readers copy them while writers may be modifying the table.
+
+    Implementation details:
+        - open addressing with linear probing. Each slot has an atomic control word, which holds slot state
+          (EMPTY, BUSY, USED or DELETED) in the lowest two bits and a generation counter in the rest of the bits.
+          Generation is incremented on every state change, so readers can detect that a slot was reused;
+        - readers never lock or wait. Slot is read and then its control word is checked again, if it has changed the slot is read again;
+        - writers lock one of NUM_LOCK_STRIPES spin locks selected by key hash, so writers of the same key are serialized.
+          Free slot is claimed with a CAS on its control word, so writers of different keys don't need a common lock;
+        - removed slot becomes DELETED and can be reused by writers. Slots never become EMPTY again, so probe sequences
+          are never broken for readers;
+        - resize locks all stripes, copies USED slots to a new table and publishes it with a single atomic store.
+          Readers which still use the old table see a consistent snapshot, so old tables are not freed until
+          concurrent_hash_map_free_retired_tables or concurrent_hash_map_destroy. Table size usually doubles on
+          resize, so retired tables take about as much memory as the current one. Only tables with lots of DELETED
+          slots are rehashed at the same size.
+*/
+
+#include <type_traits>
+
+#include "engine/types.h"
+#include "engine/memory/memory.h"
+#include "engine/platform/platform_atomics.h"
+#include "engine/platform/platform_threads.h"
+#include "engine/utilities/bits.h"
+#include "engine/utilities/hash_map.h"
+#include "engine/utilities/spin_lock.h"
+
+namespace al
+{
+    template<typename Key, typename Value>
+    struct ConcurrentHashMap
+    {
+        static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>);
+        static constexpr u64 STATE_EMPTY = 0;
+        static constexpr u64 STATE_BUSY = 1;
+        static constexpr u64 STATE_USED = 2;
+        static constexpr u64 STATE_DELETED = 3;
+        static constexpr u64 STATE_MASK = 3;
+        static constexpr u64 GENERATION_STEP = 4;
+        static constexpr uSize NUM_LOCK_STRIPES = 16;
+        static constexpr uSize MIN_CAPACITY = 128;
+        struct Slot
+        {
+            Atomic<u64> control;
+            Hash hash;
+            Key key;
+            Value value;
+        };
+        struct Table
+        {
+            Table* retired;             // previous table, kept alive for readers which might still use it
+            Slot* slots;
+            uSize capacity;             // always a power of two
+            Atomic<u64> numOccupied;    // USED, BUSY and DELETED slots
+        };
+        struct LockStripe
+        {
+            SpinLock lock;
+            u8 __padding[64 - sizeof(SpinLock)];
+        };
+        AllocatorBindings allocator;
+        Atomic<Table*> table;
+        Atomic<u64> size;
+        LockStripe stripes[NUM_LOCK_STRIPES];
+    };
+
+    template<typename Key, typename Value>
+    ConcurrentHashMap<Key, Value>::Table* concurrent_hash_map_create_table(ConcurrentHashMap<Key, Value>* map, uSize capacity)
+    {
+        using Map = ConcurrentHashMap<Key, Value>;
+        typename Map::Table* table = allocate<typename Map::Table>(&map->allocator);
+        table->retired = nullptr;
+        table->slots = allocate<typename Map::Slot>(&map->allocator, capacity);
+        table->capacity = capacity;
+        platform_atomic_64_bit_store(&table->numOccupied, u64(0), MemoryOrder::RELAXED);
+        std::memset(table->slots, 0, sizeof(typename Map::Slot) * capacity);
+        return table;
+    }
+
+    template<typename Key, typename Value>
+    void concurrent_hash_map_destroy_table(ConcurrentHashMap<Key, Value>* map, typename ConcurrentHashMap<Key, Value>::Table* table)
+    {
+        using Map = ConcurrentHashMap<Key, Value>;
+        deallocate<typename Map::Slot>(&map->allocator, table->slots, table->capacity);
+        deallocate<typename Map::Table>(&map->allocator, table, 1);
+    }
+
+    template<typename Key, typename Value>
+    void concurrent_hash_map_construct(ConcurrentHashMap<Key, Value>* map, AllocatorBindings* allocator, uSize capacity = 128)
+    {
+        using Map = ConcurrentHashMap<Key, Value>;
+        // Each of the concurrent writers can claim a slot after the load check, so the table must be noticeably larger than the number of stripes
+        capacity = uSize(1) << log2_ceil(capacity < Map::MIN_CAPACITY ? Map::MIN_CAPACITY : capacity);
+        map->allocator = *allocator;
+        platform_atomic_64_bit_store(&map->table, concurrent_hash_map_create_table(map, capacity), MemoryOrder::RELEASE);
+        platform_atomic_64_bit_store(&map->size, u64(0), MemoryOrder::RELAXED);
+        for (uSize it = 0; it < Map::NUM_LOCK_STRIPES; it++)
+        {
+            spin_lock_construct(&map->stripes[it].lock);
+        }
+    }
+
+    template<typename Key, typename Value>
+    void concurrent_hash_map_free_retired_tables(ConcurrentHashMap<Key, Value>* map)
+    {
+        // @NOTE : must not be called while other threads are using the map
+        typename ConcurrentHashMap<Key, Value>::Table* table = platform_atomic_64_bit_load(&map->table, MemoryOrder::ACQUIRE);
+        while (table->retired)
+        {
+            typename ConcurrentHashMap<Key, Value>::Table* retired = table->retired;
+            table->retired = retired->retired;
+            concurrent_hash_map_destroy_table(map, retired);
+        }
+    }
+
+    template<typename Key, typename Value>
+    void concurrent_hash_map_destroy(ConcurrentHashMap<Key, Value>* map)
+    {
+        concurrent_hash_map_free_retired_tables(map);
+        concurrent_hash_map_destroy_table(map, platform_atomic_64_bit_load(&map->table, MemoryOrder::ACQUIRE));
+    }
+
+    template<typename Key, typename Value>
+    uSize concurrent_hash_map_size(ConcurrentHashMap<Key, Value>* map)
+    {
+        return platform_atomic_64_bit_load(&map->size, MemoryOrder::RELAXED);
+    }
+
+    //
+    // Writer locks
+    //
+
+    template<typename Key, typename Value>
+    uSize concurrent_hash_map_stripe_index(Hash hash)
+    {
+        // Lowest bits select the slot, so stripe is selected with the highest ones
+        return uSize(hash >> 32) & (ConcurrentHashMap<Key, Value>::NUM_LOCK_STRIPES - 1);
+    }
+
+    template<typename Key, typename Value>
+    void concurrent_hash_map_lock_stripe(ConcurrentHashMap<Key, Value>* map, uSize stripe)
+    {
+        spin_lock_lock(&map->stripes[stripe].lock);
+    }
+
+    template<typename Key, typename Value>
+    void concurrent_hash_map_unlock_stripe(ConcurrentHashMap<Key, Value>* map, uSize stripe)
+    {
+        spin_lock_unlock(&map->stripes[stripe].lock);
+    }
+
+    template<typename Key, typename Value>
+    bool concurrent_hash_map_needs_resize(typename ConcurrentHashMap<Key, Value>::Table* table)
+    {
+        // Every stripe owner can claim one more slot after this check, so they are accounted here. Max load factor is 3/4
+        const u64 numOccupied = platform_atomic_64_bit_load(&table->numOccupied, MemoryOrder::RELAXED);
+        return numOccupied + ConcurrentHashMap<Key, Value>::NUM_LOCK_STRIPES > table->capacity - table->capacity / 4;
+    }
+
+    template<typename Key, typename Value>
+    void concurrent_hash_map_resize(ConcurrentHashMap<Key, Value>* map)
+    {
+        using Map = ConcurrentHashMap<Key, Value>;
+        for (uSize it = 0; it < Map::NUM_LOCK_STRIPES; it++)
+        {
+            concurrent_hash_map_lock_stripe(map, it);
+        }
+        // Other writer could have resized the table while this thread was waiting for locks
+        typename Map::Table* oldTable = platform_atomic_64_bit_load(&map->table, MemoryOrder::ACQUIRE);
+        if (concurrent_hash_map_needs_resize<Key, Value>(oldTable))
+        {
+            // If most of the occupied slots are DELETED, dropping them is enough
+            const u64 size = platform_atomic_64_bit_load(&map->size, MemoryOrder::RELAXED);
+            const uSize newCapacity = size <= oldTable->capacity / 4 ? oldTable->capacity : oldTable->capacity * 2;
+            typename Map::Table* newTable = concurrent_hash_map_create_table(map, newCapacity);
+            const uSize mask = newCapacity - 1;
+            // All writers are locked out and readers never modify slots, so there is no need for atomics here
+            for (uSize it = 0; it < oldTable->capacity; it++)
+            {
+                typename Map::Slot* oldSlot = &oldTable->slots[it];
+                if ((oldSlot->control.value & Map::STATE_MASK) != Map::STATE_USED)
+                {
+                    continue;
+                }
+                uSize index = oldSlot->hash & mask;
+                while (newTable->slots[index].control.value != Map::STATE_EMPTY)
+                {
+                    index = (index + 1) & mask;
+                }
+                typename Map::Slot* newSlot = &newTable->slots[index];
+                newSlot->hash = oldSlot->hash;
+                newSlot->key = oldSlot->key;
+                newSlot->value = oldSlot->value;
+                newSlot->control.value = Map::STATE_USED;
+            }
+            platform_atomic_64_bit_store(&newTable->numOccupied, size, MemoryOrder::RELAXED);
+            newTable->retired = oldTable;
+            platform_atomic_64_bit_store(&map->table, newTable, MemoryOrder::RELEASE);
+        }
+        for (uSize it = 0; it < Map::NUM_LOCK_STRIPES; it++)
+        {
+            concurrent_hash_map_unlock_stripe(map, it);
+        }
+    }
+
+    //
+    // Slot access
+    //
+
+    template<typename Key, typename Value>
+    bool concurrent_hash_map_find(typename ConcurrentHashMap<Key, Value>::Table* table, const Key* key, Hash hash, Value* value, uSize* resultIndex, u64* resultControl)
+    {
+        //
+        // Reads are optimistic : slot data is copied and then control word is checked again.
+        // BUSY slot is a key which is not inserted yet, so it is skipped in the same way as DELETED one.
+        // Table always has EMPTY slots (see concurrent_hash_map_needs_resize), so this loop always ends.
+        //
+        using Map = ConcurrentHashMap<Key, Value>;
+        const uSize mask = table->capacity - 1;
+        for (uSize index = hash & mask; ; index = (index + 1) & mask)
+        {
+            typename Map::Slot* slot = &table->slots[index];
+            while (true)
+            {
+                const u64 control = platform_atomic_64_bit_load(&slot->control, MemoryOrder::ACQUIRE);
+                const u64 state = control & Map::STATE_MASK;
+                if (state == Map::STATE_EMPTY)
+                {
+                    return false;
+                }
+                if (state != Map::STATE_USED)
+                {
+                    break;
+                }
+                const Hash slotHash = slot->hash;
+                const Key slotKey = slot->key;
+                Value slotValue;
+                if (value)
+                {
+                    slotValue = slot->value;
+                }
+                if (platform_atomic_64_bit_load(&slot->control, MemoryOrder::ACQUIRE) != control)
+                {
+                    // Slot was changed while it was read
+                    continue;
+                }
+                if (slotHash != hash || !hash_key_compare(&slotKey, key))
+                {
+                    break;
+                }
+                if (value)
+                {
+                    *value = slotValue;
+                }
+                if (resultIndex)
+                {
+                    *resultIndex = index;
+                    *resultControl = control;
+                }
+                return true;
+            }
+        }
+    }
+
+    template<typename Key, typename Value>
+    bool concurrent_hash_map_get(ConcurrentHashMap<Key, Value>* map, const Key* key, Value* value)
+    {
+        typename ConcurrentHashMap<Key, Value>::Table* table = platform_atomic_64_bit_load(&map->table, MemoryOrder::ACQUIRE);
+        return concurrent_hash_map_find<Key, Value>(table, key, hash_compute(key), value, nullptr, nullptr);
+    }
+
+    template<typename Key, typename Value>
+    bool concurrent_hash_map_add(ConcurrentHashMap<Key, Value>* map, const Key* key, const Value* value)
+    {
+        using Map = ConcurrentHashMap<Key, Value>;
+        const Hash hash = hash_compute(key);
+        const uSize stripe = concurrent_hash_map_stripe_index<Key, Value>(hash);
+        while (true)
+        {
+            concurrent_hash_map_lock_stripe(map, stripe);
+            // Table can't be replaced while any stripe is locked
+            typename Map::Table* table = platform_atomic_64_bit_load(&map->table, MemoryOrder::ACQUIRE);
+            if (concurrent_hash_map_find<Key, Value>(table, key, hash, nullptr, nullptr, nullptr))
+            {
+                concurrent_hash_map_unlock_stripe(map, stripe);
+                return false;
+            }
+            if (concurrent_hash_map_needs_resize<Key, Value>(table))
+            {
+                concurrent_hash_map_unlock_stripe(map, stripe);
+                concurrent_hash_map_resize(map);
+                continue;
+            }
+            // First DELETED or EMPTY slot in the probe sequence is claimed. If other writer claims it first, probing continues
+            const uSize mask = table->capacity - 1;
+            for (uSize index = hash & mask; ; index = (index + 1) & mask)
+            {
+                typename Map::Slot* slot = &table->slots[index];
+                u64 control = platform_atomic_64_bit_load(&slot->control, MemoryOrder::ACQUIRE);
+                const u64 state = control & Map::STATE_MASK;
+                if (state != Map::STATE_EMPTY && state != Map::STATE_DELETED)
+                {
+                    continue;
+                }
+                const u64 generation = (control & ~Map::STATE_MASK) + Map::GENERATION_STEP;
+                if (!platform_atomic_64_bit_cas(&slot->control, &control, generation | Map::STATE_BUSY, MemoryOrder::ACQUIRE_RELEASE))
+                {
+                    continue;
+                }
+                if (state == Map::STATE_EMPTY)
+                {
+                    platform_atomic_64_bit_increment(&table->numOccupied);
+                }
+                slot->hash = hash;
+                slot->key = *key;
+                slot->value = *value;
+                platform_atomic_64_bit_store(&slot->control, generation | Map::STATE_USED, MemoryOrder::RELEASE);
+                break;
+            }
+            platform_atomic_64_bit_increment(&map->size);
+            concurrent_hash_map_unlock_stripe(map, stripe);
+            return true;
+        }
+    }
+
+    template<typename Key, typename Value>
+    bool concurrent_hash_map_remove(ConcurrentHashMap<Key, Value>* map, const Key* key)
+    {
+        using Map = ConcurrentHashMap<Key, Value>;
+        const Hash hash = hash_compute(key);
+        const uSize stripe = concurrent_hash_map_stripe_index<Key, Value>(hash);
+        concurrent_hash_map_lock_stripe(map, stripe);
+        typename Map::Table* table = platform_atomic_64_bit_load(&map->table, MemoryOrder::ACQUIRE);
+        uSize index;
+        u64 control;
+        const bool isFound = concurrent_hash_map_find<Key, Value>(table, key, hash, nullptr, &index, &control);
+        if (isFound)
+        {
+            // Only the owner of this stripe can change a USED slot with this key, so CAS always succeeds.
+            // Slot data is left untouched, readers which already copied it still get a consistent result
+            const u64 generation = (control & ~Map::STATE_MASK) + Map::GENERATION_STEP;
+            const bool isChanged = platform_atomic_64_bit_cas(&table->slots[index].control, &control, generation | Map::STATE_DELETED, MemoryOrder::ACQUIRE_RELEASE);
+            al_assert_msg(isChanged, "Concurrent hash map slot was modified by a writer which doesn't own the stripe");
+            platform_atomic_64_bit_decrement(&map->size);
+        }
+        concurrent_hash_map_unlock_stripe(map, stripe);
+        return isFound;
+    }
+
+    //
+    // Specializations for c-style strings
+    //
+
+    template<cstring Key, typename Value>
+    bool concurrent_hash_map_add(ConcurrentHashMap<Key, Value>* map, Key key, const Value* value)
+    {
+        return concurrent_hash_map_add(map, &key, value);
+    }
+
+    template<cstring Key, typename Value>
+    bool concurrent_hash_map_get(ConcurrentHashMap<Key, Value>* map, Key key, Value* value)
+    {
+        return concurrent_hash_map_get(map, &key, value);
+    }
+
+    template<cstring Key, typename Value>
+    bool concurrent_hash_map_remove(ConcurrentHashMap<Key, Value>* map, Key key)
+    {
+        return concurrent_hash_map_remove(map, &key);
+    }
+}
+
+#endif
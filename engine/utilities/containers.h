@@ -22,17 +22,23 @@ namespace al
     //     return DataBlockSize / 8;
     // }
 
+    template<typename T> struct PointerWithSize;
+
+    // @NOTE :  Elements are stored in fixed-size blocks which never move, so pointers to elements
+    //          stay valid while storage grows. Block directory gives O(1) access to any element.
     template<typename T, uSize DataBlockSize>
     struct DataBlockStorage
     {
+        static constexpr uSize INITIAL_DIRECTORY_CAPACITY = 4;
         struct DataBlock
         {
-            DataBlock* next;
             // u8 ledger[__get_data_block_storage_ledger_size<DataBlockSize>()];
             T data[DataBlockSize];
         };
         AllocatorBindings bindings;
-        DataBlock* firstBlock;
+        DataBlock** blocks;
+        uSize numBlocks;
+        uSize directoryCapacity;
         uSize capacity;
         uSize size;
         T& operator [] (uSize index);
@@ -41,14 +47,25 @@ namespace al
     template<typename T, uSize DataBlockSize>
     T& DataBlockStorage<T, DataBlockSize>::operator [] (uSize index)
     {
-        uSize blockIndex = index / DataBlockSize;
-        uSize inBlockIndex = index % DataBlockSize;
-        DataBlock* block = firstBlock;
-        for (uSize it = 0; it < blockIndex; it++)
+        return blocks[index / DataBlockSize]->data[index % DataBlockSize];
+    }
+
+    template<typename T, uSize DataBlockSize>
+    void data_block_storage_add_block(DataBlockStorage<T, DataBlockSize>* storage)
+    {
+        using DataBlock = DataBlockStorage<T, DataBlockSize>::DataBlock;
+        if (storage->numBlocks == storage->directoryCapacity)
         {
-            block = block->next;
+            const uSize newDirectoryCapacity = storage->directoryCapacity * 2;
+            DataBlock** newBlocks = reallocate<DataBlock*>(&storage->bindings, storage->blocks, storage->directoryCapacity, newDirectoryCapacity);
+            al_assert_msg(newBlocks, "Unable to grow data block storage directory");
+            storage->blocks = newBlocks;
+            storage->directoryCapacity = newDirectoryCapacity;
         }
-        return block->data[inBlockIndex];
+        DataBlock* block = allocate<DataBlock>(&storage->bindings);
+        std::memset(block, 0, sizeof(DataBlock));
+        storage->blocks[storage->numBlocks++] = block;
+        storage->capacity += DataBlockSize;
     }
 
     template<typename T, uSize DataBlockSize>
@@ -56,23 +73,20 @@ namespace al
     {
         using DataBlock = DataBlockStorage<T, DataBlockSize>::DataBlock;
         storage->bindings = *bindings;
-        storage->firstBlock = allocate<DataBlock>(&storage->bindings);
-        storage->capacity = DataBlockSize;
+        storage->blocks = allocate<DataBlock*>(&storage->bindings, DataBlockStorage<T, DataBlockSize>::INITIAL_DIRECTORY_CAPACITY);
+        storage->numBlocks = 0;
+        storage->directoryCapacity = DataBlockStorage<T, DataBlockSize>::INITIAL_DIRECTORY_CAPACITY;
+        storage->capacity = 0;
         storage->size = 0;
-        std::memset(storage->firstBlock, 0, sizeof(DataBlock));
+        data_block_storage_add_block(storage);
     }
 
     template<typename T, uSize DataBlockSize>
     T* data_block_storage_add(DataBlockStorage<T, DataBlockSize>* storage)
     {
-        using DataBlock = DataBlockStorage<T, DataBlockSize>::DataBlock;
         if (storage->size == storage->capacity)
         {
-            DataBlock* lastBlock = storage->firstBlock;
-            while (lastBlock->next) lastBlock = lastBlock->next;
-            lastBlock->next = allocate<DataBlock>(&storage->bindings);
-            std::memset(lastBlock->next, 0, sizeof(DataBlock));
-            storage->capacity += DataBlockSize;
+            data_block_storage_add_block(storage);
         }
         return &(*storage)[storage->size++];
     }
@@ -80,7 +94,6 @@ namespace al
     template<typename T, uSize DataBlockSize>
     bool data_block_storage_remove(DataBlockStorage<T, DataBlockSize>* storage, uSize index)
     {
-        using DataBlock = DataBlockStorage<T, DataBlockSize>::DataBlock;
         if (index >= storage->size)
         {
             return false;
@@ -98,20 +111,15 @@ namespace al
     template<typename T, uSize DataBlockSize>
     bool data_block_storage_remove(DataBlockStorage<T, DataBlockSize>* storage, T* entry)
     {
-        using DataBlock = DataBlockStorage<T, DataBlockSize>::DataBlock;
         uSize index = storage->size;
-        DataBlock* block = storage->firstBlock;
-        uSize blockIt = 0;
-        while (block->next)
+        for (uSize blockIt = 0; blockIt < storage->numBlocks; blockIt++)
         {
-            if ((entry - block->data) >= DataBlockSize || entry < block->data)
+            T* data = storage->blocks[blockIt]->data;
+            if (entry >= data && entry < (data + DataBlockSize))
             {
-                block = block->next;
-                blockIt++;
-                continue;
+                index = blockIt * DataBlockSize + (entry - data);
+                break;
             }
-            index = blockIt * DataBlockSize + (entry - block->data);
-            break;
         }
         return data_block_storage_remove(storage, index);
     }
@@ -120,13 +128,11 @@ namespace al
     void data_block_storage_destruct(DataBlockStorage<T, DataBlockSize>* storage)
     {
         using DataBlock = DataBlockStorage<T, DataBlockSize>::DataBlock;
-        DataBlock* block = storage->firstBlock;
-        while (block)
+        for (uSize it = 0; it < storage->numBlocks; it++)
         {
-            DataBlock* blockToDelete = block;
-            block = block->next;
-            deallocate<DataBlock>(&storage->bindings, blockToDelete);
+            deallocate<DataBlock>(&storage->bindings, storage->blocks[it]);
         }
+        deallocate<DataBlock*>(&storage->bindings, storage->blocks, storage->directoryCapacity);
         std::memset(storage, 0, sizeof(DataBlockStorage<T, DataBlockSize>));
     }
 
@@ -165,6 +171,66 @@ namespace al
         return &(*iterator.storage)[iterator.index];
     }
 
+    template<typename T, uSize DataBlockSize>
+    uSize to_index(DataBlockStorageIterator<T, DataBlockSize> iterator)
+    {
+        return iterator.index;
+    }
+
+    // @NOTE :  Block iterator visits contiguous ranges of used elements, one range per block.
+    //          Usage :
+    //              for (auto it = data_block_storage_create_block_iterator(&storage); !is_finished(&it); advance(&it))
+    //              {
+    //                  PointerWithSize<T> range = get(it);
+    //                  for (uSize rangeIt = 0; rangeIt < range.size; rangeIt++) process(&range.ptr[rangeIt]);
+    //              }
+    template<typename T, uSize DataBlockSize>
+    struct DataBlockStorageBlockIterator
+    {
+        DataBlockStorage<T, DataBlockSize>* storage;
+        uSize blockIndex;
+    };
+
+    template<typename T, uSize DataBlockSize>
+    DataBlockStorageBlockIterator<T, DataBlockSize> data_block_storage_create_block_iterator(DataBlockStorage<T, DataBlockSize>* storage)
+    {
+        return
+        {
+            .storage = storage,
+            .blockIndex = 0,
+        };
+    }
+
+    template<typename T, uSize DataBlockSize>
+    void advance(DataBlockStorageBlockIterator<T, DataBlockSize>* iterator)
+    {
+        iterator->blockIndex += 1;
+    }
+
+    template<typename T, uSize DataBlockSize>
+    bool is_finished(DataBlockStorageBlockIterator<T, DataBlockSize>* iterator)
+    {
+        return (iterator->blockIndex * DataBlockSize) >= iterator->storage->size;
+    }
+
+    template<typename T, uSize DataBlockSize>
+    PointerWithSize<T> get(DataBlockStorageBlockIterator<T, DataBlockSize> iterator)
+    {
+        const uSize firstIndex = iterator.blockIndex * DataBlockSize;
+        const uSize rangeSize = iterator.storage->size - firstIndex;
+        return
+        {
+            .ptr = iterator.storage->blocks[iterator.blockIndex]->data,
+            .size = rangeSize < DataBlockSize ? rangeSize : DataBlockSize,
+        };
+    }
+
+    template<typename T, uSize DataBlockSize>
+    uSize to_index(DataBlockStorageBlockIterator<T, DataBlockSize> iterator)
+    {
+        return iterator.blockIndex;
+    }
+
     //
     // Pointer with size
     //
@@ -288,9 +354,10 @@ namespace al
         if (array->size == array->capacity)
         {
             const uSize newCapacity = array->capacity * 2;
-            T* newMemory = allocate<T>(&array->bindings, newCapacity);
-            std::memcpy(newMemory, array->memory, sizeof(T) * array->capacity);
+            T* newMemory = reallocate<T>(&array->bindings, array->memory, array->capacity, newCapacity);
+            al_assert_msg(newMemory, "Unable to grow dynamic array");
             std::memset(newMemory + array->capacity, 0, (newCapacity - array->capacity) * sizeof(T));
+            array->memory = newMemory;
             array->capacity = newCapacity;
         }
         return &array->memory[array->size++];
@@ -326,6 +393,95 @@ namespace al
     template<typename T> T* get(DynamicArrayIterator<T> iterator) { return &(*iterator.storage)[iterator.index]; }
     template<typename T> uSize to_index(DynamicArrayIterator<T> iterator) { return iterator.index; }
 
+    //
+    // Small Array
+    //
+
+    // @NOTE :  Up to InlineCapacity elements are stored inside of the array itself, so short-lived small lists
+    //          don't touch the allocator at all. Bigger arrays spill to memory allocated with bindings.
+    //          Inline storage is addressed through small_array_data, so array object can be moved with memcpy.
+    template<typename T, uSize InlineCapacity>
+    struct SmallArray
+    {
+        static_assert(InlineCapacity > 0, "SmallArray must have inline capacity, use DynamicArray otherwise");
+        AllocatorBindings bindings;
+        T* heapMemory;      // used only if capacity > InlineCapacity
+        uSize size;
+        uSize capacity;
+        T inlineMemory[InlineCapacity];
+        T& operator [] (uSize index);
+    };
+
+    template<typename T, uSize InlineCapacity>
+    T* small_array_data(SmallArray<T, InlineCapacity>* array)
+    {
+        return array->capacity > InlineCapacity ? array->heapMemory : array->inlineMemory;
+    }
+
+    template<typename T, uSize InlineCapacity>
+    void small_array_construct(SmallArray<T, InlineCapacity>* array, AllocatorBindings* bindings, uSize size = 0)
+    {
+        array->bindings = *bindings;
+        array->size = size;
+        array->capacity = size > InlineCapacity ? size : InlineCapacity;
+        array->heapMemory = size > InlineCapacity ? allocate<T>(bindings, size) : nullptr;
+        al_assert_msg(size <= InlineCapacity || array->heapMemory, "Unable to allocate small array");
+        std::memset(small_array_data(array), 0, array->capacity * sizeof(T));
+    }
+
+    template<typename T, uSize InlineCapacity>
+    void small_array_destruct(SmallArray<T, InlineCapacity>* array)
+    {
+        if (array->heapMemory)
+        {
+            deallocate<T>(&array->bindings, array->heapMemory, array->capacity);
+        }
+        std::memset(array, 0, sizeof(SmallArray<T, InlineCapacity>));
+    }
+
+    template<typename T, uSize InlineCapacity>
+    T* small_array_add(SmallArray<T, InlineCapacity>* array)
+    {
+        if (array->size == array->capacity)
+        {
+            const uSize newCapacity = array->capacity * 2;
+            T* newMemory = nullptr;
+            if (array->heapMemory)
+            {
+                newMemory = reallocate<T>(&array->bindings, array->heapMemory, array->capacity, newCapacity);
+            }
+            else
+            {
+                newMemory = allocate<T>(&array->bindings, newCapacity);
+                if (newMemory) std::memcpy(newMemory, array->inlineMemory, array->size * sizeof(T));
+            }
+            al_assert_msg(newMemory, "Unable to grow small array");
+            std::memset(newMemory + array->capacity, 0, (newCapacity - array->capacity) * sizeof(T));
+            array->heapMemory = newMemory;
+            array->capacity = newCapacity;
+        }
+        return &small_array_data(array)[array->size++];
+    }
+
+    template<typename T, uSize InlineCapacity>
+    T& SmallArray<T, InlineCapacity>::operator [] (uSize index)
+    {
+        return small_array_data(this)[index];
+    }
+
+    template<typename T, uSize InlineCapacity>
+    struct SmallArrayIterator
+    {
+        SmallArray<T, InlineCapacity>* storage;
+        uSize index;
+    };
+
+    template<typename T, uSize InlineCapacity> SmallArrayIterator<T, InlineCapacity> create_iterator(SmallArray<T, InlineCapacity>* storage) { return { storage, 0, }; }
+    template<typename T, uSize InlineCapacity> void advance(SmallArrayIterator<T, InlineCapacity>* iterator) { iterator->index += 1; }
+    template<typename T, uSize InlineCapacity> bool is_finished(SmallArrayIterator<T, InlineCapacity>* iterator) { return iterator->index >= iterator->storage->size; }
+    template<typename T, uSize InlineCapacity> T* get(SmallArrayIterator<T, InlineCapacity> iterator) { return &(*iterator.storage)[iterator.index]; }
+    template<typename T, uSize InlineCapacity> uSize to_index(SmallArrayIterator<T, InlineCapacity> iterator) { return iterator.index; }
+
     template<typename T, uSize Size>
     struct CArrayIterator
     {
@@ -338,6 +494,170 @@ namespace al
     template<typename T, uSize Size> bool is_finished(CArrayIterator<T, Size>* iterator) { return iterator->index >= Size; }
     template<typename T, uSize Size> T* get(CArrayIterator<T, Size> iterator) { return &iterator.storage[iterator.index]; }
     template<typename T, uSize Size> uSize to_index(CArrayIterator<T, Size> iterator) { return iterator.index; }
+
+    //
+    // Slot Map
+    //
+
+    // @NOTE :  Objects are stored densely (removal moves the last object into the freed place), so iteration
+    //          touches only live objects. Objects are referenced with handles, which go through the slot array.
+    //          Each slot has a generation which is incremented on removal, so stale handles are detected
+    //          with a single comparison. Zero generation is never used, so zero-initialized handle is always invalid.
+    //          Pointers returned by slot_map_add and slot_map_get are invalidated by any add or remove.
+    struct SlotMapHandle
+    {
+        u32 index;
+        u32 generation;
+    };
+
+    template<typename T>
+    struct SlotMap
+    {
+        static constexpr u32 INVALID_INDEX = ~u32(0);
+        struct Slot
+        {
+            u32 denseIndex;     // index of the next free slot if this slot is free
+            u32 generation;
+        };
+        AllocatorBindings bindings;
+        T* dense;
+        u32* denseToSlot;
+        Slot* slots;
+        u32 size;
+        u32 numSlots;
+        u32 capacity;           // capacity of dense, denseToSlot and slots arrays
+        u32 freeListHead;
+    };
+
+    template<typename T>
+    void slot_map_construct(SlotMap<T>* map, AllocatorBindings* bindings, u32 initialCapacity = 16)
+    {
+        using Slot = SlotMap<T>::Slot;
+        // Capacity is doubled on growth, so it must never be zero
+        initialCapacity = initialCapacity > 0 ? initialCapacity : 1;
+        map->bindings = *bindings;
+        map->dense = allocate<T>(&map->bindings, initialCapacity);
+        map->denseToSlot = allocate<u32>(&map->bindings, initialCapacity);
+        map->slots = allocate<Slot>(&map->bindings, initialCapacity);
+        map->size = 0;
+        map->numSlots = 0;
+        map->capacity = initialCapacity;
+        map->freeListHead = SlotMap<T>::INVALID_INDEX;
+        std::memset(map->dense, 0, initialCapacity * sizeof(T));
+    }
+
+    template<typename T>
+    void slot_map_destruct(SlotMap<T>* map)
+    {
+        using Slot = SlotMap<T>::Slot;
+        deallocate<T>(&map->bindings, map->dense, map->capacity);
+        deallocate<u32>(&map->bindings, map->denseToSlot, map->capacity);
+        deallocate<Slot>(&map->bindings, map->slots, map->capacity);
+        std::memset(map, 0, sizeof(SlotMap<T>));
+    }
+
+    template<typename T>
+    void slot_map_grow(SlotMap<T>* map)
+    {
+        using Slot = SlotMap<T>::Slot;
+        const u32 newCapacity = map->capacity * 2;
+        T* newDense = reallocate<T>(&map->bindings, map->dense, map->capacity, newCapacity);
+        u32* newDenseToSlot = reallocate<u32>(&map->bindings, map->denseToSlot, map->capacity, newCapacity);
+        Slot* newSlots = reallocate<Slot>(&map->bindings, map->slots, map->capacity, newCapacity);
+        al_assert_msg(newDense && newDenseToSlot && newSlots, "Unable to grow slot map");
+        std::memset(newDense + map->capacity, 0, (newCapacity - map->capacity) * sizeof(T));
+        map->dense = newDense;
+        map->denseToSlot = newDenseToSlot;
+        map->slots = newSlots;
+        map->capacity = newCapacity;
+    }
+
+    template<typename T>
+    T* slot_map_add(SlotMap<T>* map, SlotMapHandle* handle)
+    {
+        using Slot = SlotMap<T>::Slot;
+        // Slots are added only when the free list is empty, so numSlots never exceeds size of the dense array
+        if (map->size == map->capacity)
+        {
+            slot_map_grow(map);
+        }
+        u32 slotIndex = map->freeListHead;
+        if (slotIndex == SlotMap<T>::INVALID_INDEX)
+        {
+            slotIndex = map->numSlots++;
+            map->slots[slotIndex].generation = 1;
+        }
+        else
+        {
+            map->freeListHead = map->slots[slotIndex].denseIndex;
+        }
+        Slot* slot = &map->slots[slotIndex];
+        slot->denseIndex = map->size;
+        map->denseToSlot[map->size] = slotIndex;
+        *handle = { slotIndex, slot->generation };
+        return &map->dense[map->size++];
+    }
+
+    template<typename T>
+    T* slot_map_get(SlotMap<T>* map, SlotMapHandle handle)
+    {
+        if (handle.index >= map->numSlots || map->slots[handle.index].generation != handle.generation)
+        {
+            return nullptr;
+        }
+        return &map->dense[map->slots[handle.index].denseIndex];
+    }
+
+    template<typename T>
+    bool slot_map_is_valid(SlotMap<T>* map, SlotMapHandle handle)
+    {
+        return handle.index < map->numSlots && map->slots[handle.index].generation == handle.generation;
+    }
+
+    template<typename T>
+    bool slot_map_remove(SlotMap<T>* map, SlotMapHandle handle)
+    {
+        using Slot = SlotMap<T>::Slot;
+        if (!slot_map_is_valid(map, handle))
+        {
+            return false;
+        }
+        Slot* slot = &map->slots[handle.index];
+        const u32 denseIndex = slot->denseIndex;
+        const u32 lastIndex = map->size - 1;
+        if (denseIndex != lastIndex)
+        {
+            std::memcpy(&map->dense[denseIndex], &map->dense[lastIndex], sizeof(T));
+            map->denseToSlot[denseIndex] = map->denseToSlot[lastIndex];
+            map->slots[map->denseToSlot[denseIndex]].denseIndex = denseIndex;
+        }
+        std::memset(&map->dense[lastIndex], 0, sizeof(T));
+        map->size -= 1;
+        slot->generation = slot->generation == ~u32(0) ? 1 : slot->generation + 1;
+        slot->denseIndex = map->freeListHead;
+        map->freeListHead = handle.index;
+        return true;
+    }
+
+    template<typename T>
+    struct SlotMapIterator
+    {
+        SlotMap<T>* storage;
+        uSize index;
+    };
+
+    template<typename T> SlotMapIterator<T> create_iterator(SlotMap<T>* storage) { return { storage, 0, }; }
+    template<typename T> void advance(SlotMapIterator<T>* iterator) { iterator->index += 1; }
+    template<typename T> bool is_finished(SlotMapIterator<T>* iterator) { return iterator->index >= iterator->storage->size; }
+    template<typename T> T* get(SlotMapIterator<T> iterator) { return &iterator.storage->dense[iterator.index]; }
+    template<typename T> uSize to_index(SlotMapIterator<T> iterator) { return iterator.index; }
+
+    template<typename T>
+    SlotMapHandle to_handle(SlotMapIterator<T> iterator)
+    {
+        const u32 slotIndex = iterator.storage->denseToSlot[iterator.index];
+        return { slotIndex, iterator.storage->slots[slotIndex].generation };
+    }
 }
 
 #endif
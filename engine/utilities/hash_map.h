@@ -14,19 +14,40 @@
             // do stuff
         }
         UserValue* value = hash_map_get(&map, &key);
+        hash_map_reserve(&map, expectedNumberOfEntries);  // optional, avoids rehashing while adding entries
+        hash_map_shrink_to_fit(&map);                     // optional, releases memory after many removals
         hash_map_destroy(&map);
 
     Can be used directly with string literals (see "Specializations for c-style strings" section):
         hash_map_add(&map, "string key", &value);
         hash_map_add(&map, "string key", "string value");
         hash_map_add(&map, &key, "string value");
+
+    Layout is similar to SwissTable (https://abseil.io/about/design/swisstables):
+        - each entry has a separate control byte, which is either EMPTY, DELETED or holds 7 lowest bits of the entry hash;
+        - control bytes are split into groups of 16, which are scanned with a single SSE2 compare;
+        - capacity is always a power of two, so group index is computed with a mask;
+        - groups are probed quadratically, probing stops at the first group which has an EMPTY entry;
+        - removed entry becomes EMPTY if its group still has EMPTY entries (no probe sequence could have passed
+          through such group), otherwise it becomes DELETED. DELETED entries are dropped on rehash.
+          Backward-shift deletion doesn't apply here : entries are placed anywhere inside of a probed group,
+          so there is no per-entry probe distance which could be shifted back. Probe length is bounded by the load
+          factor instead - DELETED entries count against growthLeft, so at least 1/8 of control bytes are always EMPTY,
+          and once growth is used up the table is rehashed (at the same capacity if DELETED entries take at least half
+          of the used growth), so removals can't make probe sequences longer than a 7/8 full table would have.
 */
 
 #include <cstring>
 #include <type_traits>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define AL_HASH_MAP_USE_SSE2
+#   include <emmintrin.h>
+#endif
+
 #include "engine/types.h"
 #include "engine/memory/memory.h"
+#include "engine/utilities/bits.h"
 
 namespace al
 {
@@ -37,18 +58,20 @@ namespace al
     template<typename Key, typename Value>
     struct HashMap
     {
-        static constexpr uSize FREE_ENTRY = 0;
-        static constexpr uSize FIRST_VALID_HASH = 1;
+        static constexpr u8 CONTROL_EMPTY = 0x80;
+        static constexpr u8 CONTROL_DELETED = 0xFE;
+        static constexpr uSize GROUP_SIZE = 16;
         struct Entry
         {
-            Hash hash;
             Key key;
             Value value;
         };
         AllocatorBindings allocator;
+        u8* control;        // one byte per entry, high bit is set for EMPTY and DELETED entries
         Entry* entries;
-        uSize capacity;
+        uSize capacity;     // always a power of two and a multiple of GROUP_SIZE
         uSize size;
+        uSize growthLeft;   // number of EMPTY entries which can be used before table must grow
     };
 
     template<typename Key, typename Value>
@@ -73,51 +96,229 @@ namespace al
         return std::strcmp(*first, *second) == 0;
     }
 
+    //
+    // Hashing is based on wyhash (https://github.com/wangyi-fudan/wyhash, final version 4).
+    // Inputs longer than 48 bytes are processed in three independent lanes, so multiplications of
+    // different lanes overlap in the pipeline. All functions are constexpr, so hashes of string
+    // literals can be computed at compile time (see StringId).
+    //
+    constexpr u64 HASH_SECRET[4] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+
+    constexpr void hash_multiply(u64* a, u64* b)
+    {
+        // Full 64 x 64 -> 128 bit multiplication. Low half goes to a, high half goes to b
+        if (!std::is_constant_evaluated())
+        {
+#if defined(_MSC_VER) && defined(_M_X64)
+            *a = _umul128(*a, *b, b);
+            return;
+#elif defined(__SIZEOF_INT128__)
+            const unsigned __int128 result = (unsigned __int128)(*a) * (*b);
+            *a = u64(result);
+            *b = u64(result >> 64);
+            return;
+#endif
+        }
+        const u64 aHigh = *a >> 32, aLow = u32(*a), bHigh = *b >> 32, bLow = u32(*b);
+        const u64 highHigh = aHigh * bHigh, highLow = aHigh * bLow, lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+        const u64 middle = highLow + lowHigh;
+        const u64 middleCarry = u64(middle < highLow) << 32;
+        const u64 low = lowLow + (middle << 32);
+        *b = highHigh + (middle >> 32) + middleCarry + u64(low < lowLow);
+        *a = low;
+    }
+
+    constexpr u64 hash_mix(u64 a, u64 b)
+    {
+        hash_multiply(&a, &b);
+        return a ^ b;
+    }
+
+    template<typename Char>
+    constexpr u64 hash_read(const Char* data, uSize numBytes)
+    {
+        // Little-endian read of up to 8 bytes
+        if (!std::is_constant_evaluated())
+        {
+            u64 result = 0;
+            std::memcpy(&result, data, numBytes);
+            return result;
+        }
+        u64 result = 0;
+        for (uSize it = 0; it < numBytes; it++) result |= u64(u8(data[it])) << (it * 8);
+        return result;
+    }
+
+    template<typename Char>
+    constexpr Hash hash_bytes(const Char* data, uSize length, u64 seed = 0)
+    {
+        static_assert(sizeof(Char) == 1);
+        const Char* ptr = data;
+        seed ^= hash_mix(seed ^ HASH_SECRET[0], HASH_SECRET[1]);
+        u64 a = 0;
+        u64 b = 0;
+        if (length <= 16)
+        {
+            if (length >= 4)
+            {
+                a = (hash_read(ptr, 4) << 32) | hash_read(ptr + ((length >> 3) << 2), 4);
+                b = (hash_read(ptr + length - 4, 4) << 32) | hash_read(ptr + length - 4 - ((length >> 3) << 2), 4);
+            }
+            else if (length > 0)
+            {
+                a = (u64(u8(ptr[0])) << 16) | (u64(u8(ptr[length >> 1])) << 8) | u64(u8(ptr[length - 1]));
+            }
+        }
+        else
+        {
+            uSize bytesLeft = length;
+            if (bytesLeft > 48)
+            {
+                u64 seed1 = seed;
+                u64 seed2 = seed;
+                do
+                {
+                    seed  = hash_mix(hash_read(ptr,      8) ^ HASH_SECRET[1], hash_read(ptr + 8,  8) ^ seed);
+                    seed1 = hash_mix(hash_read(ptr + 16, 8) ^ HASH_SECRET[2], hash_read(ptr + 24, 8) ^ seed1);
+                    seed2 = hash_mix(hash_read(ptr + 32, 8) ^ HASH_SECRET[3], hash_read(ptr + 40, 8) ^ seed2);
+                    ptr += 48;
+                    bytesLeft -= 48;
+                } while (bytesLeft > 48);
+                seed ^= seed1 ^ seed2;
+            }
+            while (bytesLeft > 16)
+            {
+                seed = hash_mix(hash_read(ptr, 8) ^ HASH_SECRET[1], hash_read(ptr + 8, 8) ^ seed);
+                ptr += 16;
+                bytesLeft -= 16;
+            }
+            a = hash_read(ptr + bytesLeft - 16, 8);
+            b = hash_read(ptr + bytesLeft - 8, 8);
+        }
+        a ^= HASH_SECRET[1];
+        b ^= seed;
+        hash_multiply(&a, &b);
+        return hash_mix(a ^ HASH_SECRET[0] ^ length, b ^ HASH_SECRET[1]);
+    }
+
     //
     // Function for combining two hashes together.
-    // Based on boost::hash_combine : https://www.boost.org/doc/libs/1_55_0/doc/html/hash/reference.html#boost.hash_combine
     //
-    Hash hash_combine(Hash base, Hash addition)
+    constexpr Hash hash_combine(Hash base, Hash addition)
     {
-        return base ^ (addition + 0x9e3779b9 + (base << 6) + (base >> 2));
+        return hash_mix(base ^ HASH_SECRET[0], addition ^ HASH_SECRET[1]);
     }
 
     //
     // Function for computing hash of a given value.
-    // This particular implementation just takes an arbitrary data and hashes it simply
+    // This particular implementation just takes an arbitrary data and hashes it
     // using bytes of it's memory footprint.
     // User can make specializations of this function if it's required.
     //
     template<typename T>
     Hash hash_compute(const T* value)
     {
-        Hash result = 0;
-        uSize numBytes = sizeof(T);
-        const Hash* hashPtr = reinterpret_cast<const Hash*>(value);
-        while (numBytes >= sizeof(Hash))
-        {
-            result = hash_combine(result, *hashPtr);
-            hashPtr += 1;
-            numBytes -= sizeof(Hash);
-        }
-        const u8* bytePtr = reinterpret_cast<const u8*>(hashPtr);
-        while (numBytes > 0)
-        {
-            result = hash_combine(result, Hash(*bytePtr));
-            bytePtr += 1;
-            numBytes -= 1;
-        }
+        return hash_bytes(reinterpret_cast<const u8*>(value), sizeof(T));
+    }
+
+    //
+    // Compile-time string ids. Hash of the id is the same as hash_compute of the equal c-string.
+    // Usage :
+    //      constexpr StringId id = string_id("shader_name");
+    //      HashMap<StringId, Shader*> shaders;
+    //
+    struct StringId
+    {
+        Hash hash;
+    };
+
+    constexpr StringId string_id(const char* str)
+    {
+        uSize length = 0;
+        while (str[length]) length += 1;
+        return { hash_bytes(str, length) };
+    }
+
+    constexpr bool operator == (StringId one, StringId other)
+    {
+        return one.hash == other.hash;
+    }
+
+    template<>
+    Hash hash_compute<StringId>(const StringId* value)
+    {
+        return value->hash;
+    }
+
+    //
+    // Group scanning. Each function returns a bit mask with a bit set for every matching control byte of the group
+    //
+
+    u32 hash_map_group_match(const u8* group, u8 value)
+    {
+#ifdef AL_HASH_MAP_USE_SSE2
+        const __m128i controlBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return u32(_mm_movemask_epi8(_mm_cmpeq_epi8(controlBytes, _mm_set1_epi8(char(value)))));
+#else
+        u32 result = 0;
+        for (uSize it = 0; it < 16; it++) if (group[it] == value) result |= u32(1) << it;
+        return result;
+#endif
+    }
+
+    u32 hash_map_group_match_empty_or_deleted(const u8* group)
+    {
+#ifdef AL_HASH_MAP_USE_SSE2
+        // Only EMPTY and DELETED control bytes have the high bit set
+        return u32(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+        u32 result = 0;
+        for (uSize it = 0; it < 16; it++) if (group[it] & 0x80) result |= u32(1) << it;
         return result;
+#endif
+    }
+
+    //
+    // Hash is split in two parts : lowest 7 bits are stored in the control byte, the rest selects the first probed group
+    //
+
+    u8 hash_map_control_hash(Hash hash)
+    {
+        return u8(hash & 0x7F);
+    }
+
+    uSize hash_map_first_group(Hash hash, uSize capacity)
+    {
+        return (hash >> 7) & ((capacity / 16) - 1);
+    }
+
+    //
+    // Groups are probed with triangular numbers, which visits every group when number of groups is a power of two
+    //
+    uSize hash_map_probe_group(uSize currentGroup, uSize probeIteration, uSize capacity)
+    {
+        return (currentGroup + probeIteration) & ((capacity / 16) - 1);
+    }
+
+    uSize hash_map_max_growth(uSize capacity)
+    {
+        // Max load factor is 7/8
+        return capacity - capacity / 8;
     }
 
     template<typename Key, typename Value>
     void hash_map_construct(HashMap<Key, Value>* map, AllocatorBindings* allocator, uSize capacity = 128)
     {
         using Entry = HashMap<Key, Value>::Entry;
+        static_assert(HashMap<Key, Value>::GROUP_SIZE == 16);
+        capacity = uSize(1) << log2_ceil(capacity < HashMap<Key, Value>::GROUP_SIZE ? HashMap<Key, Value>::GROUP_SIZE : capacity);
         map->allocator = *allocator;
+        map->control = allocate<u8>(&map->allocator, capacity, HashMap<Key, Value>::GROUP_SIZE);
         map->entries = allocate<Entry>(&map->allocator, capacity);
         map->capacity = capacity;
         map->size = 0;
+        map->growthLeft = hash_map_max_growth(capacity);
+        std::memset(map->control, HashMap<Key, Value>::CONTROL_EMPTY, capacity);
         std::memset(map->entries, 0, sizeof(Entry) * capacity);
     }
 
@@ -125,85 +326,150 @@ namespace al
     void hash_map_destroy(HashMap<Key, Value>* map)
     {
         using Entry = HashMap<Key, Value>::Entry;
+        deallocate<u8>(&map->allocator, map->control, map->capacity);
         deallocate<Entry>(&map->allocator, map->entries, map->capacity);
     }
 
-    //
-    // This function is used when we got a hash collision and need to find a free spot for a value
-    //
-    uSize hash_map_probe_index(uSize currentIndex, uSize capacity)
+    template<typename Key, typename Value>
+    uSize hash_map_find_insert_index(HashMap<Key, Value>* map, Hash hash)
     {
-        return (currentIndex + 1) % capacity;
+        // Returns index of the first EMPTY or DELETED entry in the probe sequence
+        uSize group = hash_map_first_group(hash, map->capacity);
+        for (uSize probeIteration = 1; ; probeIteration++)
+        {
+            const u32 freeMask = hash_map_group_match_empty_or_deleted(&map->control[group * HashMap<Key, Value>::GROUP_SIZE]);
+            if (freeMask)
+            {
+                return group * HashMap<Key, Value>::GROUP_SIZE + count_trailing_zeros(freeMask);
+            }
+            group = hash_map_probe_group(group, probeIteration, map->capacity);
+        }
     }
 
     template<typename Key, typename Value>
-    void hash_map_expand(HashMap<Key, Value>* map)
+    void hash_map_resize(HashMap<Key, Value>* map, uSize newCapacity)
     {
+        //
+        // Moves all used entries to a new table. Entries are placed directly, without any load checks,
+        // and DELETED entries are dropped.
+        //
         using Entry = HashMap<Key, Value>::Entry;
         HashMap<Key, Value> newMap;
-        hash_map_construct(&newMap, &map->allocator, map->capacity * 2);
+        hash_map_construct(&newMap, &map->allocator, newCapacity);
+        al_assert_msg(map->size <= newMap.growthLeft, "Hash map capacity is too small for the current number of entries");
         for (auto it = create_iterator(map); !is_finished(&it); advance(&it))
         {
-            hash_map_add(&newMap, &get(it)->key, &get(it)->value);
+            const Hash hash = hash_compute(&get(it)->key);
+            const uSize index = hash_map_find_insert_index(&newMap, hash);
+            newMap.control[index] = hash_map_control_hash(hash);
+            std::memcpy(&newMap.entries[index], get(it), sizeof(Entry));
         }
+        newMap.size = map->size;
+        newMap.growthLeft -= map->size;
         hash_map_destroy(map);
         *map = newMap;
     }
 
+    template<typename Key, typename Value>
+    uSize hash_map_capacity_for(uSize numEntries)
+    {
+        // Smallest capacity which can hold numEntries without growing
+        uSize capacity = HashMap<Key, Value>::GROUP_SIZE;
+        while (hash_map_max_growth(capacity) < numEntries) capacity *= 2;
+        return capacity;
+    }
+
+    template<typename Key, typename Value>
+    void hash_map_rehash(HashMap<Key, Value>* map)
+    {
+        // Drops all DELETED entries without changing capacity
+        hash_map_resize(map, map->capacity);
+    }
+
+    template<typename Key, typename Value>
+    void hash_map_reserve(HashMap<Key, Value>* map, uSize numEntries)
+    {
+        const uSize capacity = hash_map_capacity_for<Key, Value>(numEntries);
+        if (capacity > map->capacity)
+        {
+            hash_map_resize(map, capacity);
+        }
+    }
+
+    template<typename Key, typename Value>
+    void hash_map_shrink_to_fit(HashMap<Key, Value>* map)
+    {
+        const uSize capacity = hash_map_capacity_for<Key, Value>(map->size);
+        if (capacity < map->capacity)
+        {
+            hash_map_resize(map, capacity);
+        }
+    }
+
+    template<typename Key, typename Value>
+    void hash_map_expand(HashMap<Key, Value>* map)
+    {
+        // If at least half of the used up growth is taken by DELETED entries, rehashing at the same capacity is enough
+        if (map->size <= hash_map_max_growth(map->capacity) / 2)
+        {
+            hash_map_rehash(map);
+        }
+        else
+        {
+            hash_map_resize(map, map->capacity * 2);
+        }
+    }
+
     template<typename Key, typename Value>
     void hash_map_add(HashMap<Key, Value>* map, const Key* key, const Value* value)
     {
         using Entry = HashMap<Key, Value>::Entry;
-        if ((f64(map->size) / f64(map->capacity)) > 0.7)
+        const Hash hash = hash_compute(key);
+        uSize index = hash_map_find_insert_index(map, hash);
+        if (map->growthLeft == 0 && map->control[index] == HashMap<Key, Value>::CONTROL_EMPTY)
         {
+            // DELETED entries can be reused without growing
             hash_map_expand(map);
+            index = hash_map_find_insert_index(map, hash);
         }
-        Hash hash = hash_compute(key);
-        if (hash < HashMap<Key, Value>::FIRST_VALID_HASH) hash += HashMap<Key, Value>::FIRST_VALID_HASH;
-        uSize index = hash % map->capacity;
-        while (true)
+        if (map->control[index] == HashMap<Key, Value>::CONTROL_EMPTY)
         {
-            Entry* entry = &map->entries[index];
-            if (entry->hash < HashMap<Key, Value>::FIRST_VALID_HASH)
-            {
-                entry->hash = hash;
-                entry->key = *key;
-                entry->value = *value;
-                map->size += 1;
-                break;
-            }
-            else
-            {
-                index = hash_map_probe_index(index, map->capacity);
-            }
+            map->growthLeft -= 1;
         }
+        map->control[index] = hash_map_control_hash(hash);
+        Entry* entry = &map->entries[index];
+        entry->key = *key;
+        entry->value = *value;
+        map->size += 1;
     }
 
     template<typename Key, typename Value>
     HashMap<Key, Value>::Entry* hash_map_find_entry(HashMap<Key, Value>* map, const Key* key)
     {
         //
-        // Probing through the map utils we find correct of empty entry.
-        // We always need at least one empty entry in the table for the hash_map_find_entry function to work.
+        // Entries with matching control bytes are compared group by group until a group with an EMPTY entry is found.
+        // Table always has EMPTY entries (see growthLeft), so this loop always ends.
         //
-        using Entry = HashMap<Key, Value>::Entry;
-        Hash hash = hash_compute(key);
-        if (hash < HashMap<Key, Value>::FIRST_VALID_HASH) hash += HashMap<Key, Value>::FIRST_VALID_HASH;
-        uSize index = hash % map->capacity;
-        Entry* entry = &map->entries[index];
-        while (entry->hash >= HashMap<Key, Value>::FIRST_VALID_HASH)
+        const Hash hash = hash_compute(key);
+        const u8 controlHash = hash_map_control_hash(hash);
+        uSize group = hash_map_first_group(hash, map->capacity);
+        for (uSize probeIteration = 1; ; probeIteration++)
         {
-            if (entry->hash == hash && hash_key_compare(&entry->key, key))
+            const u8* groupControl = &map->control[group * HashMap<Key, Value>::GROUP_SIZE];
+            for (u32 matchMask = hash_map_group_match(groupControl, controlHash); matchMask; matchMask &= matchMask - 1)
             {
-                return entry;
+                const uSize index = group * HashMap<Key, Value>::GROUP_SIZE + count_trailing_zeros(matchMask);
+                if (hash_key_compare(&map->entries[index].key, key))
+                {
+                    return &map->entries[index];
+                }
             }
-            else
+            if (hash_map_group_match(groupControl, HashMap<Key, Value>::CONTROL_EMPTY))
             {
-                index = hash_map_probe_index(index, map->capacity);
-                entry = &map->entries[index];
+                return nullptr;
             }
+            group = hash_map_probe_group(group, probeIteration, map->capacity);
         }
-        return nullptr;
     }
 
     template<typename Key, typename Value>
@@ -213,7 +479,19 @@ namespace al
         Entry* entry = hash_map_find_entry(map, key);
         if (entry)
         {
-            entry->hash = HashMap<Key, Value>::FREE_ENTRY;
+            // Probing never continues past a group with an EMPTY entry, so if this group has one, no probe
+            // sequence depends on this entry and it can become EMPTY. Otherwise it becomes DELETED.
+            const uSize index = entry - map->entries;
+            const u8* groupControl = &map->control[index & ~(HashMap<Key, Value>::GROUP_SIZE - 1)];
+            if (hash_map_group_match(groupControl, HashMap<Key, Value>::CONTROL_EMPTY))
+            {
+                map->control[index] = HashMap<Key, Value>::CONTROL_EMPTY;
+                map->growthLeft += 1;
+            }
+            else
+            {
+                map->control[index] = HashMap<Key, Value>::CONTROL_DELETED;
+            }
             map->size -= 1;
         }
         return entry ? &entry->value : nullptr;
@@ -231,23 +509,37 @@ namespace al
     // Iterator
     //
 
-    template<typename Key, typename Value> HashMapIterator<Key, Value> create_iterator(HashMap<Key, Value>* storage)
+    template<typename Key, typename Value>
+    uSize hash_map_find_used_index(HashMap<Key, Value>* map, uSize from)
     {
-        uSize index = 0;
-        do
+        // Returns index of the first used entry starting from "from" or capacity if there is no such entry
+        if (from >= map->capacity)
+        {
+            return map->capacity;
+        }
+        uSize group = from / HashMap<Key, Value>::GROUP_SIZE;
+        u32 usedMask = ~hash_map_group_match_empty_or_deleted(&map->control[group * HashMap<Key, Value>::GROUP_SIZE]) & (0xFFFF << (from % HashMap<Key, Value>::GROUP_SIZE)) & 0xFFFF;
+        while (!usedMask)
         {
-            index += 1;
-        } while (storage->entries[index].hash == HashMap<Key, Value>::FREE_ENTRY);
-        return { storage, index };
+            group += 1;
+            if (group * HashMap<Key, Value>::GROUP_SIZE >= map->capacity)
+            {
+                return map->capacity;
+            }
+            usedMask = ~hash_map_group_match_empty_or_deleted(&map->control[group * HashMap<Key, Value>::GROUP_SIZE]) & 0xFFFF;
+        }
+        return group * HashMap<Key, Value>::GROUP_SIZE + count_trailing_zeros(usedMask);
+    }
+
+    template<typename Key, typename Value> HashMapIterator<Key, Value> create_iterator(HashMap<Key, Value>* storage)
+    {
+        return { storage, hash_map_find_used_index(storage, 0) };
     }
     
     template<typename Key, typename Value>
     void advance(HashMapIterator<Key, Value>* iterator)
     {
-        do
-        {
-            iterator->index += 1;
-        } while (iterator->storage->entries[iterator->index].hash == HashMap<Key, Value>::FREE_ENTRY);
+        iterator->index = hash_map_find_used_index(iterator->storage, iterator->index + 1);
     }
 
     template<typename Key, typename Value>
@@ -269,23 +561,7 @@ namespace al
     template<>
     Hash hash_compute<const char*>(const char* const* value)
     {
-        Hash result = 0;
-        uSize numBytes = std::strlen(*value);
-        const Hash* hashPtr = reinterpret_cast<const Hash*>(*value);
-        while (numBytes >= sizeof(Hash))
-        {
-            result = hash_combine(result, *hashPtr);
-            hashPtr += 1;
-            numBytes -= sizeof(Hash);
-        }
-        const u8* bytePtr = reinterpret_cast<const u8*>(hashPtr);
-        while (numBytes > 0)
-        {
-            result = hash_combine(result, hash_compute(bytePtr));
-            bytePtr += 1;
-            numBytes -= 1;
-        }
-        return result;
+        return hash_bytes(*value, std::strlen(*value));
     }
 
     template<>
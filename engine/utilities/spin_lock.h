@@ -0,0 +1,51 @@
+#ifndef AL_SPIN_LOCK_H
+#define AL_SPIN_LOCK_H
+
+#include "engine/types.h"
+#include "engine/platform/platform_atomics.h"
+#include "engine/platform/platform_threads.h" // Can't just include platform.h because of circular dependencies. Sad!
+
+namespace al
+{
+    //
+    // Spin lock for short critical sections (allocator buckets, hash map stripes).
+    // Waiter yields while the lock is taken and retries the exchange only when the lock looks free, so it doesn't hammer the cache line.
+    // Lock is not recursive. For long critical sections use PlatformMutex instead.
+    //
+    // @NOTE :  Lock word is a full 64-bit value, so compare-exchange never touches Atomic<T> padding.
+    //          Zero-initialized SpinLock is unlocked, so it can be used without construction.
+    //
+    struct SpinLock
+    {
+        Atomic<u64> isLocked;
+    };
+
+    inline void spin_lock_construct(SpinLock* lock)
+    {
+        platform_atomic_64_bit_store(&lock->isLocked, u64(0), MemoryOrder::RELAXED);
+    }
+
+    inline bool spin_lock_try_lock(SpinLock* lock)
+    {
+        u64 expected = 0;
+        return platform_atomic_64_bit_cas(&lock->isLocked, &expected, u64(1), MemoryOrder::ACQUIRE_RELEASE);
+    }
+
+    inline void spin_lock_lock(SpinLock* lock)
+    {
+        while (!spin_lock_try_lock(lock))
+        {
+            while (platform_atomic_64_bit_load(&lock->isLocked, MemoryOrder::RELAXED))
+            {
+                platform_thread_yield();
+            }
+        }
+    }
+
+    inline void spin_lock_unlock(SpinLock* lock)
+    {
+        platform_atomic_64_bit_store(&lock->isLocked, u64(0), MemoryOrder::RELEASE);
+    }
+}
+
+#endif
@@ -4,18 +4,24 @@
 #include <cstring>
 
 #include "engine/types.h"
-#include "engine/memory/memory.h"
 #include "engine/platform/platform_threads.h" // Can't just include platform.h because of circular dependencies. Sad!
 #include "engine/platform/platform_atomics.h"
 
 namespace al
 {
+    //
+    // Each thread gets its own slot in the storage. Index of the slot is cached in an OS thread local storage key,
+    // so access is a single lookup instead of a scan over thread ids. Ids are scanned only on the first access
+    // of a thread (slot of a finished thread with the same id is reused) or if the key couldn't be created.
+    //
     template<typename T, uSize Capacity>
     struct ThreadLocalStorage
     {
         T memory[Capacity];
-        PlatformThreadId threadIds[Capacity];
+        Atomic<PlatformThreadId> threadIds[Capacity];
         Atomic<uSize> size;
+        PlatformTlsKey slotKey;     // value is slot index + 1, nullptr if thread has no slot yet
+        bool hasSlotKey;
         void (*storageItemConstructor)(T*);
     };
 
@@ -24,42 +30,63 @@ namespace al
     {
         storage->storageItemConstructor = storageItemConstructor;
         storage->size = 0;
+        storage->hasSlotKey = platform_tls_key_create(&storage->slotKey);
         std::memset(storage->memory, 0, Capacity * sizeof(T));
-        std::memset(storage->threadIds, 0, Capacity * sizeof(PlatformThreadId));
+        std::memset(storage->threadIds, 0, Capacity * sizeof(Atomic<PlatformThreadId>));
     }
 
     template<typename T, uSize Capacity>
     void tls_destroy(ThreadLocalStorage<T, Capacity>* storage)
     {
-        
+        if (storage->hasSlotKey)
+        {
+            platform_tls_key_destroy(storage->slotKey);
+            storage->hasSlotKey = false;
+        }
     }
 
     template<typename T, uSize Capacity>
-    T* tls_access(ThreadLocalStorage<T, Capacity>* storage)
+    T* tls_acquire_slot(ThreadLocalStorage<T, Capacity>* storage)
     {
-        PlatformThreadId currentThreadId = platform_get_current_thread_id();
-        for (uSize it = 0; it < storage->size; it++)
+        const PlatformThreadId currentThreadId = platform_get_current_thread_id();
+        uSize size = platform_atomic_64_bit_load(&storage->size, MemoryOrder::ACQUIRE);
+        for (uSize it = 0; it < size; it++)
         {
-            if (storage->threadIds[it] == currentThreadId)
+            if (platform_atomic_64_bit_load(&storage->threadIds[it], MemoryOrder::ACQUIRE) == currentThreadId)
             {
+                if (storage->hasSlotKey) platform_tls_set(storage->slotKey, reinterpret_cast<void*>(it + 1));
                 return &storage->memory[it];
             }
         }
-        if (storage->size == Capacity)
-        {
-            return nullptr;
-        }
-        uSize expected = storage->size;
-        uSize newSize = storage->size + 1;
-        while (!platform_atomic_64_bit_cas(&storage->size, &expected, newSize, MemoryOrder::ACQUIRE_RELEASE))
+        // Size is checked on every try, so concurrent threads can't reserve slots past the capacity
+        do
         {
-            newSize = expected + 1;
-        }
-        storage->threadIds[newSize - 1] = currentThreadId;
-        T* tlsItem = &storage->memory[newSize - 1];
+            if (size >= Capacity)
+            {
+                return nullptr;
+            }
+        } while (!platform_atomic_64_bit_cas(&storage->size, &size, size + 1, MemoryOrder::ACQUIRE_RELEASE));
+        T* tlsItem = &storage->memory[size];
         if (storage->storageItemConstructor) storage->storageItemConstructor(tlsItem);
+        // Id is published after the item is constructed, so id scans never see a half-initialized slot
+        platform_atomic_64_bit_store(&storage->threadIds[size], currentThreadId, MemoryOrder::RELEASE);
+        if (storage->hasSlotKey) platform_tls_set(storage->slotKey, reinterpret_cast<void*>(size + 1));
         return tlsItem;
     }
+
+    template<typename T, uSize Capacity>
+    T* tls_access(ThreadLocalStorage<T, Capacity>* storage)
+    {
+        if (storage->hasSlotKey)
+        {
+            const uSize slot = reinterpret_cast<uSize>(platform_tls_get(storage->slotKey));
+            if (slot)
+            {
+                return &storage->memory[slot - 1];
+            }
+        }
+        return tls_acquire_slot(storage);
+    }
 }
 
 #endif
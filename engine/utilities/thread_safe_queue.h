@@ -47,6 +47,15 @@ namespace al
         
     }
 
+    // @NOTE : result is only a hint if other threads use the queue at the same time
+    template<typename T>
+    bool thread_safe_queue_is_empty(ThreadSafeQueue<T>* queue)
+    {
+        const u64 dequeuePos = platform_atomic_64_bit_load(&queue->dequeuePos, MemoryOrder::ACQUIRE);
+        const u64 enqueuePos = platform_atomic_64_bit_load(&queue->enqueuePos, MemoryOrder::ACQUIRE);
+        return enqueuePos == dequeuePos;
+    }
+
     template<typename T>
     bool thread_safe_queue_enqueue(ThreadSafeQueue<T>* queue, const T* data)
     {
@@ -132,6 +141,188 @@ namespace al
         platform_atomic_64_bit_store(&cell->sequence, pos + queue->bufferMask + 1, MemoryOrder::RELEASE);
         return true;
     }
+
+    // @NOTE :  Bulk operations reserve a contiguous range of cells with a single CAS. Range ends at the first cell
+    //          which is not ready, so these functions can process fewer elements than requested.
+    //          Return value is the number of enqueued/dequeued elements.
+    template<typename T>
+    uSize thread_safe_queue_enqueue_bulk(ThreadSafeQueue<T>* queue, const T* data, uSize count)
+    {
+        // Load current enqueue position
+        u64 pos = platform_atomic_64_bit_load(&queue->enqueuePos, MemoryOrder::RELAXED);
+        uSize numReserved;
+        while(true)
+        {
+            // Count cells which are ready for write
+            numReserved = 0;
+            std::intptr_t diff = 0;
+            while (numReserved < count)
+            {
+                u64 seq = platform_atomic_64_bit_load(&queue->buffer[(pos + numReserved) & queue->bufferMask].sequence, MemoryOrder::ACQUIRE);
+                diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + numReserved);
+                if (diff != 0) break;
+                numReserved += 1;
+            }
+            if (numReserved)
+            {
+                // Try to reserve all ready cells at once
+                if (platform_atomic_64_bit_cas(&queue->enqueuePos, &pos, pos + numReserved, MemoryOrder::RELAXED))
+                {
+                    break;
+                }
+            }
+            // Queue is full
+            else if (diff < 0 || count == 0)
+            {
+                return 0;
+            }
+            // First cell was changed by some other thread
+            else
+            {
+                pos = platform_atomic_64_bit_load(&queue->enqueuePos, MemoryOrder::RELAXED);
+            }
+        }
+        for (uSize it = 0; it < numReserved; it++)
+        {
+            typename ThreadSafeQueue<T>::Cell* cell = &queue->buffer[(pos + it) & queue->bufferMask];
+            cell->data = data[it];
+            platform_atomic_64_bit_store(&cell->sequence, pos + it + 1, MemoryOrder::RELEASE);
+        }
+        return numReserved;
+    }
+
+    template<typename T>
+    uSize thread_safe_queue_dequeue_bulk(ThreadSafeQueue<T>* queue, T* data, uSize maxCount)
+    {
+        // Load current dequeue position
+        u64 pos = platform_atomic_64_bit_load(&queue->dequeuePos, MemoryOrder::RELAXED);
+        uSize numReserved;
+        while(true)
+        {
+            // Count cells which are ready for read
+            numReserved = 0;
+            std::intptr_t diff = 0;
+            while (numReserved < maxCount)
+            {
+                u64 seq = platform_atomic_64_bit_load(&queue->buffer[(pos + numReserved) & queue->bufferMask].sequence, MemoryOrder::ACQUIRE);
+                diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + numReserved + 1);
+                if (diff != 0) break;
+                numReserved += 1;
+            }
+            if (numReserved)
+            {
+                // Try to reserve all ready cells at once
+                if (platform_atomic_64_bit_cas(&queue->dequeuePos, &pos, pos + numReserved, MemoryOrder::RELAXED))
+                {
+                    break;
+                }
+            }
+            // Queue is empty
+            else if (diff < 0 || maxCount == 0)
+            {
+                return 0;
+            }
+            // First cell was changed by some other thread
+            else
+            {
+                pos = platform_atomic_64_bit_load(&queue->dequeuePos, MemoryOrder::RELAXED);
+            }
+        }
+        for (uSize it = 0; it < numReserved; it++)
+        {
+            typename ThreadSafeQueue<T>::Cell* cell = &queue->buffer[(pos + it) & queue->bufferMask];
+            data[it] = cell->data;
+            platform_atomic_64_bit_store(&cell->sequence, pos + it + queue->bufferMask + 1, MemoryOrder::RELEASE);
+        }
+        return numReserved;
+    }
+
+    // @NOTE :  Queue for exactly one producer thread and one consumer thread. Each side owns its position,
+    //          so no CAS is needed. Each side also caches the position of the other side and reloads it
+    //          only when the queue looks full (or empty), so most operations touch only the owner's cache line.
+    template<typename T>
+    struct SpscQueue
+    {
+        typedef u8 CachelinePadding[64];
+
+        CachelinePadding    pad0;
+        T*                  buffer;
+        u64                 bufferMask;
+        CachelinePadding    pad1;
+        Atomic<u64>         enqueuePos;
+        u64                 cachedDequeuePos;   // used only by producer
+        CachelinePadding    pad2;
+        Atomic<u64>         dequeuePos;
+        u64                 cachedEnqueuePos;   // used only by consumer
+        CachelinePadding    pad3;
+    };
+
+    // @NOTE : size must be a power of two
+    template<typename T>
+    void spsc_queue_construct(SpscQueue<T>* queue, T* memory, u64 size)
+    {
+        queue->buffer = memory;
+        queue->bufferMask = size - 1;
+        platform_atomic_64_bit_store(&queue->enqueuePos, u64(0), MemoryOrder::RELAXED);
+        platform_atomic_64_bit_store(&queue->dequeuePos, u64(0), MemoryOrder::RELAXED);
+        queue->cachedDequeuePos = 0;
+        queue->cachedEnqueuePos = 0;
+    }
+
+    template<typename T>
+    void spsc_queue_destruct(SpscQueue<T>* queue)
+    {
+
+    }
+
+    template<typename T>
+    uSize spsc_queue_enqueue_bulk(SpscQueue<T>* queue, const T* data, uSize count)
+    {
+        const u64 pos = platform_atomic_64_bit_load(&queue->enqueuePos, MemoryOrder::RELAXED);
+        const u64 size = queue->bufferMask + 1;
+        if (size - (pos - queue->cachedDequeuePos) < count)
+        {
+            queue->cachedDequeuePos = platform_atomic_64_bit_load(&queue->dequeuePos, MemoryOrder::ACQUIRE);
+        }
+        const u64 numFree = size - (pos - queue->cachedDequeuePos);
+        const uSize numEnqueued = count < numFree ? count : uSize(numFree);
+        for (uSize it = 0; it < numEnqueued; it++)
+        {
+            queue->buffer[(pos + it) & queue->bufferMask] = data[it];
+        }
+        platform_atomic_64_bit_store(&queue->enqueuePos, pos + numEnqueued, MemoryOrder::RELEASE);
+        return numEnqueued;
+    }
+
+    template<typename T>
+    uSize spsc_queue_dequeue_bulk(SpscQueue<T>* queue, T* data, uSize maxCount)
+    {
+        const u64 pos = platform_atomic_64_bit_load(&queue->dequeuePos, MemoryOrder::RELAXED);
+        if (queue->cachedEnqueuePos - pos < maxCount)
+        {
+            queue->cachedEnqueuePos = platform_atomic_64_bit_load(&queue->enqueuePos, MemoryOrder::ACQUIRE);
+        }
+        const u64 numReady = queue->cachedEnqueuePos - pos;
+        const uSize numDequeued = maxCount < numReady ? maxCount : uSize(numReady);
+        for (uSize it = 0; it < numDequeued; it++)
+        {
+            data[it] = queue->buffer[(pos + it) & queue->bufferMask];
+        }
+        platform_atomic_64_bit_store(&queue->dequeuePos, pos + numDequeued, MemoryOrder::RELEASE);
+        return numDequeued;
+    }
+
+    template<typename T>
+    bool spsc_queue_enqueue(SpscQueue<T>* queue, const T* data)
+    {
+        return spsc_queue_enqueue_bulk(queue, data, 1) == 1;
+    }
+
+    template<typename T>
+    bool spsc_queue_dequeue(SpscQueue<T>* queue, T* data)
+    {
+        return spsc_queue_dequeue_bulk(queue, data, 1) == 1;
+    }
 }
 
 #endif
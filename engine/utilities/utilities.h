@@ -19,10 +19,12 @@
 #include "defer.h"
 #include "containers.h"
 #include "hash_map.h"
+#include "concurrent_hash_map.h"
 #include "tuple.h"
 #include "thread_local_storage.h"
 #include "allocations_tracker.h"
 #include "bits.h"
 #include "thread_safe_queue.h"
+#include "adaptive_wait.h"
 
 #endif
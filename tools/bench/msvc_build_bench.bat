@@ -0,0 +1,12 @@
+call vcvars64
+
+call cl ^
+-O2 -EHsc -MT ^
+tools\bench\pool_free_list_bench.cpp ^
+/std:c++latest /w34996 ^
+/I "." /I "%VK_SDK_PATH%\Include" ^
+kernel32.lib user32.lib Gdi32.lib  Ole32.lib ^
+%VK_SDK_PATH%\Lib\vulkan-1.lib ^
+/link /DEBUG:NONE
+
+pause
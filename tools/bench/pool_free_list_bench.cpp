@@ -0,0 +1,98 @@
+
+//
+// Single-block allocation benchmark on a fragmented pool allocator bucket.
+//
+// Bucket of 8-byte blocks is filled to 90% and a random half of the blocks is freed, so free blocks are
+// scattered across the ledger. Then random single blocks are freed and allocated again, pair after pair:
+//  - "ledger scan" flushes the free list after every deallocation, so each allocation searches the ledger
+//    for a free block (how single blocks were allocated before the bucket free list);
+//  - "free list" uses the bucket as is, single blocks are pushed to and popped from the free list.
+//
+// Build with msvc_build_bench.bat from the repository root.
+//
+
+#define AL_IMPLEMENTATION
+#include "engine/engine.h"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace al;
+
+static constexpr uSize BLOCK_SIZE_BYTES = 8;
+static constexpr uSize BUCKET_SIZE_BYTES = 2 * 1024 * 1024;
+static constexpr uSize NUM_PAIRS = 200000;
+
+struct BenchRandom
+{
+    u64 state;
+};
+
+u64 bench_random_next(BenchRandom* random)
+{
+    random->state ^= random->state << 13;
+    random->state ^= random->state >> 7;
+    random->state ^= random->state << 17;
+    return random->state;
+}
+
+// Returns number of live blocks, their pointers are written to the blocks array
+uSize bench_fragment_bucket(PoolAllocatorMemoryBucket* bucket, void** blocks, BenchRandom* random)
+{
+    const uSize numAllocated = bucket->blockCount * 9 / 10;
+    for (uSize it = 0; it < numAllocated; it++)
+    {
+        blocks[it] = memory_bucket_allocate(bucket, BLOCK_SIZE_BYTES, BLOCK_SIZE_BYTES);
+    }
+    // Fisher-Yates shuffle, first half of the shuffled blocks is freed
+    for (uSize it = numAllocated - 1; it > 0; it--)
+    {
+        const uSize other = bench_random_next(random) % (it + 1);
+        void* tmp = blocks[it];
+        blocks[it] = blocks[other];
+        blocks[other] = tmp;
+    }
+    const uSize numFreed = numAllocated / 2;
+    for (uSize it = 0; it < numFreed; it++)
+    {
+        memory_bucket_deallocate(bucket, blocks[it], BLOCK_SIZE_BYTES);
+    }
+    memory_bucket_flush_free_list(bucket);
+    std::memmove(blocks, blocks + numFreed, (numAllocated - numFreed) * sizeof(void*));
+    return numAllocated - numFreed;
+}
+
+f64 bench_run(bool useFreeList)
+{
+    AllocatorBindings bindings = get_system_allocator_bindings();
+    void* memory = allocate(&bindings, BUCKET_SIZE_BYTES, EngineConfig::MAX_MEMORY_ALIGNMENT);
+    PoolAllocatorMemoryBucket bucket;
+    memory_bucket_construct(&bucket, BLOCK_SIZE_BYTES, BUCKET_SIZE_BYTES / BLOCK_SIZE_BYTES, memory, &bindings);
+    void** blocks = allocate<void*>(&bindings, bucket.blockCount);
+    BenchRandom random{ 0x9E3779B97F4A7C15ull };
+    const uSize numBlocks = bench_fragment_bucket(&bucket, blocks, &random);
+    const auto start = std::chrono::steady_clock::now();
+    for (uSize it = 0; it < NUM_PAIRS; it++)
+    {
+        const uSize blockId = bench_random_next(&random) % numBlocks;
+        memory_bucket_deallocate(&bucket, blocks[blockId], BLOCK_SIZE_BYTES);
+        if (!useFreeList)
+        {
+            memory_bucket_flush_free_list(&bucket);
+        }
+        blocks[blockId] = memory_bucket_allocate(&bucket, BLOCK_SIZE_BYTES, BLOCK_SIZE_BYTES);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    deallocate<void*>(&bindings, blocks, bucket.blockCount);
+    memory_bucket_destruct(&bucket, &bindings);
+    deallocate(&bindings, memory, BUCKET_SIZE_BYTES);
+    return std::chrono::duration<f64, std::nano>(end - start).count() / f64(NUM_PAIRS);
+}
+
+int main(int argc, char* argv[])
+{
+    std::printf("Fragmented bucket : %zu blocks of %zu bytes, %zu free + allocate pairs\n", uSize(BUCKET_SIZE_BYTES / BLOCK_SIZE_BYTES), BLOCK_SIZE_BYTES, NUM_PAIRS);
+    std::printf("ledger scan : %8.1f ns per pair\n", bench_run(false));
+    std::printf("free list   : %8.1f ns per pair\n", bench_run(true));
+    return 0;
+}